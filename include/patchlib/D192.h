@@ -20,15 +20,6 @@ class D192Rack: public Rack
 {
 Q_OBJECT
     friend D192Rom;
-public:
-    [[nodiscard]] Phase getPhaseForLug(unsigned int lug) const override;
-    [[nodiscard]] unsigned int getLugForCircuit(unsigned int circuit) const override;
-    [[nodiscard]] unsigned int getCircuitForLug(unsigned int lug) const override;
-    [[nodiscard]] unsigned int getLugCount() const override;
-    [[nodiscard]] unsigned int getLugsPerModule() const override;
-    [[nodiscard]] unsigned int getModuleDensityForLug(unsigned int lug) const override;
-    [[nodiscard]] QString getModuleNameForLug(unsigned int lug) const override;
-
 protected:
     void initLugAddressMap() override;
 
@@ -0,0 +1,117 @@
+/**
+ * @file EditJournal.h
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#ifndef EDITJOURNAL_H
+#define EDITJOURNAL_H
+
+#include <QObject>
+#include <QFile>
+#include <QLockFile>
+#include <QTimer>
+#include <memory>
+#include "Rom.h"
+
+namespace patchman
+{
+
+/**
+ * Append-only log of a ROM's unsaved lug edits, so they can be recovered if the program does not exit normally.
+ *
+ * The journal starts with the ROM's image; each edit then appends only the changed lug words. Edits are collected and
+ * synced to disk in batches. Journals are deleted by discard() when their editor closes, so any journal left in
+ * getJournalDir() that no running instance holds belongs to a session that ended abnormally.
+ */
+class EditJournal: public QObject
+{
+Q_OBJECT
+public:
+    ~EditJournal() override;
+
+    /**
+     * Start journaling edits to @p rom.
+     *
+     * @param rom
+     * @param romPath Where @p rom was loaded from, or empty if it has never been saved.
+     * @param parent
+     * @return The new journal, or `nullptr` if it could not be created. Edits are not recoverable in that case.
+     */
+    static EditJournal *create(Rom *rom, const QString &romPath, QObject *parent = nullptr);
+
+    /**
+     * Write all pending edits to disk now.
+     */
+    void flush();
+
+    /**
+     * Start the journal over from the ROM's current contents, e.g. after it is saved to @p romPath.
+     *
+     * @param romPath
+     */
+    void reset(const QString &romPath);
+
+    /**
+     * Stop journaling and delete the journal.
+     */
+    void discard();
+
+    /**
+     * Get the directory journals are kept in.
+     */
+    static QString getJournalDir();
+
+    /**
+     * Find journals left behind by sessions that ended without saving or closing their ROMs.
+     *
+     * @return Journal paths.
+     */
+    static QStringList findAbandoned();
+
+    struct Recovered
+    {
+        /** Where the ROM was loaded from, or empty if it was never saved. */
+        QString romPath;
+        Rom *rom = nullptr;
+    };
+
+    /**
+     * Rebuild the ROM recorded in @p journalPath, with every edit that reached the disk.
+     *
+     * @param journalPath
+     * @param parent
+     * @return
+     * @throws InvalidRomException when the journal is unreadable.
+     */
+    static Recovered recover(const QString &journalPath, QObject *parent = nullptr);
+
+    /**
+     * Delete the journal at @p journalPath.
+     *
+     * @param journalPath
+     */
+    static void remove(const QString &journalPath);
+
+private:
+    static constexpr int kFlushDelay = 1000;
+    static constexpr qsizetype kMaxPendingBytes = 4096;
+    Rom *rom_;
+    QFile file_;
+    std::unique_ptr<QLockFile> lock_;
+    /** Records not yet written. */
+    QByteArray pending_;
+    QTimer *flushTimer_;
+
+    EditJournal(Rom *rom, const QString &journalPath, QObject *parent);
+
+    void writeHeader(const QString &romPath);
+    void track(Rack *rack);
+    void append(const Rack *rack, unsigned int firstLug, unsigned int lastLug);
+};
+
+} // patchman
+
+#endif //EDITJOURNAL_H
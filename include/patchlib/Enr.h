@@ -28,6 +28,11 @@ Q_OBJECT
 public:
     static constexpr auto kMaxAnalog = 4;
 
+    /**
+     * Bits of a lug word used by ENR racks. The bits between the address and analog channel are unused.
+     */
+    static constexpr uint16_t kLugWordMask = kLugWordAddressMask | kLugWordAnalogMask;
+
     friend bool operator==(const EnrRack &lhs, const EnrRack &rhs);
 
     friend bool operator!=(const EnrRack &lhs, const EnrRack &rhs)
@@ -35,11 +40,6 @@ public:
         return !(rhs == lhs);
     }
 
-    [[nodiscard]] unsigned int getLugCount() const override;
-    [[nodiscard]] unsigned int getLugsPerModule() const override;
-    [[nodiscard]] unsigned int getModuleDensityForLug(unsigned int lug) const override;
-    [[nodiscard]] QString getModuleNameForLug(unsigned int lug) const override;
-    [[nodiscard]] Phase getPhaseForLug(unsigned int lug) const override;
     [[nodiscard]] unsigned int getLugAnalogChan(unsigned int lug) const;
 
     /**
@@ -56,8 +56,6 @@ protected:
     void initLugAddressMap() override;
 
 private:
-    QList<unsigned int> lugAnalog_;
-
     using Rack::Rack;
     void fromByteArray(QByteArrayView data);
     [[nodiscard]] QByteArray toByteArray() const;
@@ -113,14 +111,27 @@ public:
 protected:
     [[nodiscard]] QByteArray getSoftwareHash() const override;
     [[nodiscard]] QByteArray getPatchHash() const override;
+    [[nodiscard]] uint8_t getPatchTableVariant() const override;
+    void setPatchTableVariant(uint8_t variant) override;
 
 Q_SIGNALS:
     void versionChanged(Version newVersion);
 
 private:
     Version version_ = Version::Unknown;
-    QByteArray software_;
+    /**
+     * Software image, up to the patch tables. Embedded software is resolved on first use by getSoftware(), so creating and loading ROMs
+     * doesn't touch the resources.
+     */
+    mutable QByteArray software_;
+    /**
+     * Image bytes after the patch tables. Loaded ROMs keep their own; otherwise they are resolved from the embedded
+     * software by getSoftware().
+     */
+    mutable QByteArray trailer_;
     QByteArray software_hash_;
+
+    [[nodiscard]] const QByteArray &getSoftware() const;
 };
 
 } // patchman
@@ -0,0 +1,93 @@
+/**
+ * @file PatchTable.h
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#ifndef PATCHTABLE_H
+#define PATCHTABLE_H
+
+#include <QByteArrayView>
+#include <QCoreApplication>
+#include <QList>
+#include <QtEndian>
+#include "Rack.h"
+
+namespace patchman
+{
+
+/**
+ * Read-only view of the data returned by Rom::toPatchTable().
+ *
+ * Layout (all multibyte values little-endian):
+ * - Header: format version, ROM type, type-specific variant, rack count (1 byte each).
+ * - For each rack: rack type, lug count (1 byte each), then one 16-bit lug word per lug (see Rack::getLugWord()).
+ *
+ * The view does not copy the data, so it must outlive the view.
+ */
+class PatchTableView
+{
+    Q_DECLARE_TR_FUNCTIONS(PatchTableView)
+public:
+    /**
+     * Patch table layout version. Change this when the layout changes.
+     */
+    static constexpr uint8_t kFormat = 1;
+    static constexpr qsizetype kHeaderSize = 4;
+    static constexpr qsizetype kRackHeaderSize = 2;
+
+    /**
+     * One rack's lug words.
+     */
+    struct RackView
+    {
+        Rack::Type rackType;
+        /** Little-endian 16-bit words, one per lug. */
+        QByteArrayView words;
+
+        [[nodiscard]] unsigned int getLugCount() const
+        {
+            return static_cast<unsigned int>(words.size() / sizeof(uint16_t));
+        }
+
+        [[nodiscard]] uint16_t getLugWord(unsigned int lug) const
+        {
+            return qFromLittleEndian<uint16_t>(words.data() + lug * sizeof(uint16_t));
+        }
+    };
+
+    /**
+     * @param data
+     * @throws InvalidRomException when @p data is not a valid patch table.
+     */
+    explicit PatchTableView(QByteArrayView data);
+
+    /**
+     * The Rom::Type, as an integer.
+     */
+    [[nodiscard]] int getRomType() const
+    {
+        return romType_;
+    }
+
+    [[nodiscard]] uint8_t getVariant() const
+    {
+        return variant_;
+    }
+
+    [[nodiscard]] const QList<RackView> &getRacks() const
+    {
+        return racks_;
+    }
+
+private:
+    int romType_;
+    uint8_t variant_;
+    QList<RackView> racks_;
+};
+
+} // patchman
+
+#endif //PATCHTABLE_H
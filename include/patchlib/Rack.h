@@ -11,12 +11,19 @@
 
 #include <QObject>
 #include <QList>
+#include <algorithm>
+#include <array>
+#include <limits>
 #include <ranges>
+#include <span>
+#include <utility>
 #include "Phase.h"
 
 namespace patchman
 {
 
+struct RackDescriptor;
+
 /**
  * A single rack's patch information.
  */
@@ -44,15 +51,27 @@ public:
     [[nodiscard]] Type getRackType() const;
     void setRackType(Type rackType);
     [[nodiscard]] QString getRackName() const;
-    [[nodiscard]] virtual unsigned int getLugCount() const = 0;
-    [[nodiscard]] virtual unsigned int getLugsPerModule() const = 0;
-    [[nodiscard]] virtual unsigned int getModuleDensityForLug(unsigned int lug) const = 0;
-    [[nodiscard]] virtual QString getModuleNameForLug(unsigned int lug) const;
+
+    /**
+     * Get the static information for this rack's type.
+     *
+     * Code processing many lugs should use visitRackType() instead to have the descriptor known at compile time.
+     */
+    [[nodiscard]] const RackDescriptor &getDescriptor() const;
+
+    [[nodiscard]] unsigned int getLugCount() const
+    {
+        return lugCount_;
+    }
+
+    [[nodiscard]] unsigned int getLugsPerModule() const;
+    [[nodiscard]] unsigned int getModuleDensityForLug(unsigned int lug) const;
+    [[nodiscard]] QString getModuleNameForLug(unsigned int lug) const;
 
     /**
      * Get phase for the given lug.
      */
-    [[nodiscard]] virtual Phase getPhaseForLug(unsigned int lug) const = 0;
+    [[nodiscard]] Phase getPhaseForLug(unsigned int lug) const;
 
     /**
      * Get the DMX address for @p lug.
@@ -71,10 +90,7 @@ public:
      * @param circuit
      * @return
      */
-    [[nodiscard]] virtual unsigned int getLugForCircuit(unsigned circuit) const
-    {
-        return circuit;
-    };
+    [[nodiscard]] unsigned int getLugForCircuit(unsigned circuit) const;
 
     /**
      * Opposite of getLugForCircuit().
@@ -82,10 +98,7 @@ public:
      * @param lug
      * @return
      */
-    [[nodiscard]] virtual unsigned int getCircuitForLug(unsigned lug) const
-    {
-        return lug;
-    };
+    [[nodiscard]] unsigned int getCircuitForLug(unsigned lug) const;
 
     /**
      * Set the DMX address for @p lug. To unpatch this lug, pass `0`.
@@ -97,9 +110,138 @@ public:
      */
     void setLugAddress(unsigned int lug, unsigned int address);
 
+    /**
+     * A new DMX address for one lug, for setLugAddresses().
+     */
+    struct LugEdit
+    {
+        unsigned int lug;
+        unsigned int address;
+    };
+
+    /**
+     * Apply all of @p edits, then emit lugRangeChanged() once for the edited lugs.
+     *
+     * Prefer this to calling setLugAddress() in a loop so views only refresh once.
+     *
+     * @param edits
+     */
+    void setLugAddresses(std::span<const LugEdit> edits);
+
+    /**
+     * Bits of a lug word holding the DMX address.
+     */
+    static constexpr uint16_t kLugWordAddressMask = 0x03FF;
+
+    /**
+     * Bits of a lug word holding the analog channel, for rack types that have one.
+     */
+    static constexpr uint16_t kLugWordAnalogMask = 0xF000;
+    static constexpr unsigned int kLugWordAnalogShift = 12;
+
+    /**
+     * Most lugs in any rack type.
+     */
+    static constexpr unsigned int kMaxLugCount = 192;
+
+    /**
+     * Get all patch information for @p lug packed into one word.
+     *
+     * The DMX address is in the low bits (kLugWordAddressMask); rack types with more per-lug data store it in the
+     * high bits.
+     *
+     * @param lug
+     * @return
+     */
+    [[nodiscard]] uint16_t getLugWord(unsigned int lug) const;
+
+    /**
+     * Set all patch information for @p lug from a word returned by getLugWord().
+     *
+     * Bits this rack type does not use are ignored. Emits lugChanged().
+     *
+     * @param lug
+     * @param word
+     */
+    void setLugWord(unsigned int lug, uint16_t word);
+
+    /**
+     * Get the lug words (see getLugWord()) of every lug, in lug order.
+     */
+    [[nodiscard]] std::span<const uint16_t> getLugWords() const
+    {
+        return {lugWords_.data(), lugCount_};
+    }
+
+    /**
+     * One lug word change, as reported by lugsEdited().
+     */
+    struct LugDelta
+    {
+        uint8_t lug;
+        uint16_t before;
+        uint16_t after;
+
+        friend bool operator==(const LugDelta &lhs, const LugDelta &rhs) = default;
+    };
+    static_assert(kMaxLugCount <= std::numeric_limits<decltype(LugDelta::lug)>::max() + 1);
+
+    /**
+     * Set the lug words in @p deltas to their LugDelta::after values, or LugDelta::before values if @p reverse is set.
+     *
+     * Emits lugRangeChanged() once. Unlike the other setters this does not emit lugsEdited(), so undoing and redoing
+     * edits does not record new ones.
+     *
+     * @param deltas
+     * @param reverse
+     */
+    void applyLugDeltas(std::span<const LugDelta> deltas, bool reverse = false);
+
+    /**
+     * One lug's patch, as produced by getLugsView().
+     */
+    struct LugEntry
+    {
+        unsigned int lug;
+        /** DMX address, or 0 if unpatched. */
+        unsigned int address;
+        /** Analog channel, or 0 if unpatched or the rack type has none. */
+        unsigned int analog;
+
+        friend bool operator==(const LugEntry &lhs, const LugEntry &rhs) = default;
+    };
+
+    /**
+     * Get a random-access view of every lug's patch, in lug order.
+     *
+     * The view only refers to this rack's lug words, so it may be copied, iterated more than once, and used with
+     * parallel algorithms. It is invalidated if the rack type changes.
+     */
+    [[nodiscard]] auto getLugsView() const
+    {
+        return std::views::iota(0u, lugCount_)
+            | std::views::transform([words = getLugWords()](unsigned int lug)
+                                    {
+                                        const auto word = words[lug];
+                                        return LugEntry{
+                                            .lug = lug,
+                                            .address = static_cast<unsigned int>(word & kLugWordAddressMask),
+                                            .analog = static_cast<unsigned int>(word >> kLugWordAnalogShift),
+                                        };
+                                    });
+    }
+
+    /**
+     * Get a random-access view of (lug, address) pairs, in lug order.
+     *
+     * @see getLugsView()
+     */
     [[nodiscard]] auto getLugAddressesView() const
     {
-        return std::ranges::views::transform(lugAddresses_, LugAddressRangeTransformer());
+        return getLugsView() | std::views::transform([](const LugEntry &entry)
+                                                     {
+                                                         return std::make_pair(entry.lug, entry.address);
+                                                     });
     }
 
     /**
@@ -111,44 +253,101 @@ public:
      */
     [[nodiscard]] bool isPatched() const;
 
+    /**
+     * Get a number that increases whenever this rack changes.
+     *
+     * Versions come from one process-wide counter, so any change to any rack or ROM produces a version greater than
+     * every existing one.
+     */
+    [[nodiscard]] quint64 getEditVersion() const
+    {
+        return editVersion_;
+    }
+
+    /**
+     * Get a new edit version. See getEditVersion().
+     */
+    static quint64 nextEditVersion();
+
 Q_SIGNALS:
     void rackNumChanged();
     void rackTypeChanged();
     void lugChanged(unsigned int lug);
 
+    /**
+     * Emitted after a bulk edit. Any lug from @p firstLug to @p lastLug, inclusive, may have changed.
+     */
+    void lugRangeChanged(unsigned int firstLug, unsigned int lastLug);
+
+    /**
+     * Emitted after lugs are edited, with every lug word that changed, in lug order.
+     *
+     * Not emitted when loading a patch or by applyLugDeltas().
+     */
+    void lugsEdited(const QList<Rack::LugDelta> &deltas);
+
 protected:
     explicit Rack(unsigned int rackNum, Rack::Type rackType, QObject *parent = nullptr)
         : QObject(parent), rackNum_(rackNum), rackType_(rackType)
     {}
 
     /**
-     * Maps lugs to DMX addresses. DMX address is 1-indexed. Address 0 indicates unpatched.
+     * Lug words (see getLugWord()), in the same layout as the ROM patch tables so they can be copied in bulk. Only the
+     * first lugCount_ entries are used.
      */
-    QList<unsigned int> lugAddresses_;
+    std::array<uint16_t, kMaxLugCount> lugWords_{};
+    unsigned int lugCount_ = 0;
 
     /**
      * Initialize the lug address map.
      */
     virtual void initLugAddressMap() = 0;
 
-private:
-    unsigned int rackNum_;
-    Rack::Type rackType_;
+    /**
+     * Unpatch all lugs and set the number of lugs in use.
+     *
+     * @param lugCount
+     * @param lugWordMask Bits of each lug word this rack type uses.
+     */
+    void initLugWords(unsigned int lugCount, uint16_t lugWordMask = kLugWordAddressMask);
 
     /**
-     * View adapter to match lug numbers with addresses.
+     * Change lug words, then emit lugsEdited() for the ones that changed.
+     *
+     * @param lugs Lugs to change.
+     * @param edit Called with each lug's current word, returns the new word.
      */
-    class LugAddressRangeTransformer
+    void editLugWords(std::ranges::input_range auto &&lugs, auto &&edit)
     {
-    public:
-        std::pair<unsigned int, unsigned int> operator()(unsigned int address)
-        {
-            return std::make_pair(lug++, address);
+        QList<LugDelta> deltas;
+        for (const unsigned int lug : lugs) {
+            const auto before = lugWords_[lug];
+            const auto after = static_cast<uint16_t>(edit(lug, before) & lugWordMask_);
+            if (after != before) {
+                lugWords_[lug] = after;
+                deltas.push_back({.lug = static_cast<uint8_t>(lug), .before = before, .after = after});
+            }
         }
+        markChanged();
+        if (!deltas.empty()) {
+            std::ranges::sort(deltas, {}, &LugDelta::lug);
+            Q_EMIT(lugsEdited(deltas));
+        }
+    }
 
-    private:
-        unsigned int lug = 0;
-    };
+    /**
+     * Give this rack a new edit version. Call after changing lugWords_ directly.
+     */
+    void markChanged()
+    {
+        editVersion_ = nextEditVersion();
+    }
+
+private:
+    unsigned int rackNum_;
+    Rack::Type rackType_;
+    uint16_t lugWordMask_ = kLugWordAddressMask;
+    quint64 editVersion_ = nextEditVersion();
 };
 
 } // patchlib
@@ -0,0 +1,565 @@
+/**
+ * @file RackDescriptor.h
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#ifndef RACKDESCRIPTOR_H
+#define RACKDESCRIPTOR_H
+
+#include <QCoreApplication>
+#include <array>
+#include <source_location>
+#include <span>
+#include "Rack.h"
+
+namespace patchman
+{
+
+namespace d192
+{
+
+/**
+ * D192 circuits are numbered left to right, top to bottom; lugs are numbered top to bottom, left to right.
+ */
+inline constexpr auto kCircuitToLugMap = std::to_array<uint8_t>(
+    {
+        0,
+        1,
+        64,
+        65,
+        128,
+        129,
+        2,
+        3,
+        66,
+        67,
+        130,
+        131,
+        4,
+        5,
+        68,
+        69,
+        132,
+        133,
+        6,
+        7,
+        70,
+        71,
+        134,
+        135,
+        8,
+        9,
+        72,
+        73,
+        136,
+        137,
+        10,
+        11,
+        74,
+        75,
+        138,
+        139,
+        12,
+        13,
+        76,
+        77,
+        140,
+        141,
+        14,
+        15,
+        78,
+        79,
+        142,
+        143,
+        16,
+        17,
+        80,
+        81,
+        144,
+        145,
+        18,
+        19,
+        82,
+        83,
+        146,
+        147,
+        20,
+        21,
+        84,
+        85,
+        148,
+        149,
+        22,
+        23,
+        86,
+        87,
+        150,
+        151,
+        24,
+        25,
+        88,
+        89,
+        152,
+        153,
+        26,
+        27,
+        90,
+        91,
+        154,
+        155,
+        28,
+        29,
+        92,
+        93,
+        156,
+        157,
+        30,
+        31,
+        94,
+        95,
+        158,
+        159,
+        32,
+        33,
+        96,
+        97,
+        160,
+        161,
+        34,
+        35,
+        98,
+        99,
+        162,
+        163,
+        36,
+        37,
+        100,
+        101,
+        164,
+        165,
+        38,
+        39,
+        102,
+        103,
+        166,
+        167,
+        40,
+        41,
+        104,
+        105,
+        168,
+        169,
+        42,
+        43,
+        106,
+        107,
+        170,
+        171,
+        44,
+        45,
+        108,
+        109,
+        172,
+        173,
+        46,
+        47,
+        110,
+        111,
+        174,
+        175,
+        48,
+        49,
+        112,
+        113,
+        176,
+        177,
+        50,
+        51,
+        114,
+        115,
+        178,
+        179,
+        52,
+        53,
+        116,
+        117,
+        180,
+        181,
+        54,
+        55,
+        118,
+        119,
+        182,
+        183,
+        56,
+        57,
+        120,
+        121,
+        184,
+        185,
+        58,
+        59,
+        122,
+        123,
+        186,
+        187,
+        60,
+        61,
+        124,
+        125,
+        188,
+        189,
+        62,
+        63,
+        126,
+        127,
+        190,
+        191,
+    }
+);
+
+inline constexpr auto kLugToCircuitMap = std::to_array<uint8_t>(
+    {
+        0,
+        1,
+        6,
+        7,
+        12,
+        13,
+        18,
+        19,
+        24,
+        25,
+        30,
+        31,
+        36,
+        37,
+        42,
+        43,
+        48,
+        49,
+        54,
+        55,
+        60,
+        61,
+        66,
+        67,
+        72,
+        73,
+        78,
+        79,
+        84,
+        85,
+        90,
+        91,
+        96,
+        97,
+        102,
+        103,
+        108,
+        109,
+        114,
+        115,
+        120,
+        121,
+        126,
+        127,
+        132,
+        133,
+        138,
+        139,
+        144,
+        145,
+        150,
+        151,
+        156,
+        157,
+        162,
+        163,
+        168,
+        169,
+        174,
+        175,
+        180,
+        181,
+        186,
+        187,
+        2,
+        3,
+        8,
+        9,
+        14,
+        15,
+        20,
+        21,
+        26,
+        27,
+        32,
+        33,
+        38,
+        39,
+        44,
+        45,
+        50,
+        51,
+        56,
+        57,
+        62,
+        63,
+        68,
+        69,
+        74,
+        75,
+        80,
+        81,
+        86,
+        87,
+        92,
+        93,
+        98,
+        99,
+        104,
+        105,
+        110,
+        111,
+        116,
+        117,
+        122,
+        123,
+        128,
+        129,
+        134,
+        135,
+        140,
+        141,
+        146,
+        147,
+        152,
+        153,
+        158,
+        159,
+        164,
+        165,
+        170,
+        171,
+        176,
+        177,
+        182,
+        183,
+        188,
+        189,
+        4,
+        5,
+        10,
+        11,
+        16,
+        17,
+        22,
+        23,
+        28,
+        29,
+        34,
+        35,
+        40,
+        41,
+        46,
+        47,
+        52,
+        53,
+        58,
+        59,
+        64,
+        65,
+        70,
+        71,
+        76,
+        77,
+        82,
+        83,
+        88,
+        89,
+        94,
+        95,
+        100,
+        101,
+        106,
+        107,
+        112,
+        113,
+        118,
+        119,
+        124,
+        125,
+        130,
+        131,
+        136,
+        137,
+        142,
+        143,
+        148,
+        149,
+        154,
+        155,
+        160,
+        161,
+        166,
+        167,
+        172,
+        173,
+        178,
+        179,
+        184,
+        185,
+        190,
+        191,
+    }
+);
+
+} // d192
+
+/**
+ * Everything about a rack that depends only on its Rack::Type.
+ *
+ * Get one from RackTraits when the type is known at compile time, or from visitRackType() to iterate a rack without
+ * virtual dispatch.
+ */
+struct RackDescriptor
+{
+    Rack::Type rackType;
+    unsigned int lugCount;
+    unsigned int lugsPerModule;
+    /** Phases are assigned in consecutive blocks of this many lugs, starting with phase A. */
+    unsigned int lugsPerPhase;
+    /** Maps lugs to circuits, or nullptr if they are numbered the same. */
+    const uint8_t *lugToCircuit = nullptr;
+    /** Maps circuits to lugs, or nullptr if they are numbered the same. */
+    const uint8_t *circuitToLug = nullptr;
+    /** Translation context for moduleNames. */
+    const char *trContext;
+    /** Module name by density (the number of patched lugs in the module). */
+    std::array<const char *, 3> moduleNames;
+
+    [[nodiscard]] constexpr Phase getPhaseForLug(unsigned int lug) const
+    {
+        return static_cast<Phase>(lug / lugsPerPhase + 1);
+    }
+
+    [[nodiscard]] constexpr unsigned int getCircuitForLug(unsigned int lug) const
+    {
+        Q_ASSERT_X(lug < lugCount,
+                   std::source_location::current().function_name(),
+                   "Tried to get lug not in rack.");
+        return lugToCircuit == nullptr ? lug : lugToCircuit[lug];
+    }
+
+    [[nodiscard]] constexpr unsigned int getLugForCircuit(unsigned int circuit) const
+    {
+        Q_ASSERT_X(circuit < lugCount,
+                   std::source_location::current().function_name(),
+                   "Tried to get circuit not in rack.");
+        return circuitToLug == nullptr ? circuit : circuitToLug[circuit];
+    }
+
+    /**
+     * Get the number of patched lugs in the module containing @p lug.
+     *
+     * @param lugWords From Rack::getLugWords().
+     * @param lug
+     */
+    [[nodiscard]] constexpr unsigned int getModuleDensityForLug(std::span<const uint16_t> lugWords,
+                                                                unsigned int lug) const
+    {
+        const auto firstLug = lug - (lug % lugsPerModule);
+        unsigned int density = 0;
+        for (auto moduleLug = firstLug; moduleLug < firstLug + lugsPerModule; ++moduleLug) {
+            if ((lugWords[moduleLug] & Rack::kLugWordAddressMask) != 0) {
+                ++density;
+            }
+        }
+        return density;
+    }
+
+    [[nodiscard]] QString getModuleName(unsigned int density) const
+    {
+        if (density < moduleNames.size()) {
+            return QCoreApplication::translate(trContext, moduleNames[density]);
+        }
+        return QCoreApplication::translate("patchman::Rack", "%1 Ckt Module").arg(density);
+    }
+};
+
+template<Rack::Type>
+struct RackTraits;
+
+template<>
+struct RackTraits<Rack::Type::D192Rack>
+{
+    static constexpr RackDescriptor kDescriptor{
+        .rackType = Rack::Type::D192Rack,
+        .lugCount = 192,
+        .lugsPerModule = 2,
+        .lugsPerPhase = 64,
+        .lugToCircuit = d192::kLugToCircuitMap.data(),
+        .circuitToLug = d192::kCircuitToLugMap.data(),
+        .trContext = "patchman::D192Rack",
+        .moduleNames = {
+            QT_TRANSLATE_NOOP("patchman::D192Rack", "Blank"),
+            QT_TRANSLATE_NOOP("patchman::D192Rack", "6 kW"),
+            QT_TRANSLATE_NOOP("patchman::D192Rack", "1.2/2.4 kW"),
+        },
+    };
+    static_assert(kDescriptor.lugCount == d192::kLugToCircuitMap.size());
+    static_assert(kDescriptor.lugCount == d192::kCircuitToLugMap.size());
+};
+
+template<>
+struct RackTraits<Rack::Type::Enr96>
+{
+    static constexpr RackDescriptor kDescriptor{
+        .rackType = Rack::Type::Enr96,
+        .lugCount = 96,
+        .lugsPerModule = 2,
+        .lugsPerPhase = 32,
+        .trContext = "patchman::EnrRack",
+        .moduleNames = {
+            QT_TRANSLATE_NOOP("patchman::EnrRack", "Blank"),
+            QT_TRANSLATE_NOOP("patchman::EnrRack", "6 kW"),
+            QT_TRANSLATE_NOOP("patchman::EnrRack", "1.8/2.4 kW"),
+        },
+    };
+};
+
+/**
+ * Call @p function with the RackTraits for @p rackType.
+ *
+ * Use `decltype(traits)::kDescriptor` in @p function to get a descriptor known at compile time.
+ */
+template<typename Function>
+constexpr decltype(auto) visitRackType(Rack::Type rackType, Function &&function)
+{
+    switch (rackType) {
+        case Rack::Type::D192Rack:
+            return std::forward<Function>(function)(RackTraits<Rack::Type::D192Rack>{});
+        case Rack::Type::Enr96:
+            return std::forward<Function>(function)(RackTraits<Rack::Type::Enr96>{});
+    }
+    Q_UNREACHABLE();
+}
+
+/**
+ * Get the descriptor for @p rackType.
+ */
+[[nodiscard]] constexpr const RackDescriptor &getRackDescriptor(Rack::Type rackType)
+{
+    return visitRackType(rackType, [](auto traits) -> const RackDescriptor &
+    {
+        return decltype(traits)::kDescriptor;
+    });
+}
+
+} // patchman
+
+#endif //RACKDESCRIPTOR_H
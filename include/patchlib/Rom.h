@@ -16,6 +16,7 @@
 #include <ranges>
 #include <QtCore>
 #include "Rack.h"
+#include "RomSnapshot.h"
 #include "patchlib/library/RomInfo.h"
 
 namespace patchman
@@ -66,12 +67,25 @@ public:
      */
     static Rom *create(Rom::Type romType, QObject *parent = nullptr);
 
+    /**
+     * Create a ROM from the contents of @p path, guessing its type.
+     *
+     * The file is only read once, unlike guessType() followed by loadFromFile().
+     *
+     * @param path
+     * @param parent
+     * @return
+     * @throws InvalidRomException when the file is not a ROM.
+     */
+    static Rom *createFromFile(const QString &path, QObject *parent = nullptr);
+
     /**
      * Guess the ROM type.
      * @param path
      * @return
      */
     static Type guessType(const QString &path);
+    static Type guessType(QByteArrayView data);
 
     /**
      * Rom constructor. Do not use directly. Use createRom() instead.
@@ -105,6 +119,41 @@ public:
     [[nodiscard]] virtual QByteArray toByteArray() const = 0;
     void saveToFile(const QString &path) const;
 
+    /**
+     * Get the decoded patch in a compact form independent of the ROM's binary layout.
+     *
+     * This holds each rack's type and lug words (see Rack::getLugWord()), but not the ROM software. Use
+     * fromPatchTable() to load it.
+     *
+     * @return
+     */
+    [[nodiscard]] QByteArray toPatchTable() const;
+
+    /**
+     * Create a ROM from data returned by toPatchTable().
+     *
+     * @param data
+     * @param parent
+     * @return
+     * @throws InvalidRomException when @p data is not a valid patch table.
+     */
+    static Rom *fromPatchTable(QByteArrayView data, QObject *parent = nullptr);
+
+    /**
+     * Get a number that increases whenever this ROM's patch changes. See Rack::getEditVersion().
+     */
+    [[nodiscard]] quint64 getEditVersion() const;
+
+    /**
+     * Get an immutable snapshot of the patch for reading on other threads.
+     *
+     * The snapshot is cached until the next edit, so calling this repeatedly is cheap. Call from the thread that owns
+     * this ROM.
+     *
+     * @return
+     */
+    [[nodiscard]] RomSnapshot getSnapshot() const;
+
     /**
      * Add a rack to the patch.
      *
@@ -168,6 +217,14 @@ protected:
 
     void sortRacks();
 
+    /**
+     * Give this ROM a new edit version. Changes to racks are tracked by the racks themselves.
+     */
+    void markChanged()
+    {
+        editVersion_ = Rack::nextEditVersion();
+    }
+
     /**
      * Get a hash, using the hash algorithm returned by getHashAlgorithm(), of the software (i.e. non-modifiable) portion of the ROM.
      * @return
@@ -185,6 +242,26 @@ protected:
      * @return
      */
     static QCryptographicHash::Algorithm getHashAlgorithm();
+
+    /**
+     * Type-specific information (e.g. software version) stored in the patch table.
+     * @return
+     */
+    [[nodiscard]] virtual uint8_t getPatchTableVariant() const
+    {
+        return 0;
+    }
+
+    /**
+     * Restore the value from getPatchTableVariant().
+     * @param variant
+     */
+    virtual void setPatchTableVariant(uint8_t variant)
+    {}
+
+private:
+    quint64 editVersion_ = Rack::nextEditVersion();
+    mutable RomSnapshot snapshot_;
 };
 
 } // patchlib
@@ -0,0 +1,115 @@
+/**
+ * @file RomDiff.h
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#ifndef ROMDIFF_H
+#define ROMDIFF_H
+
+#include <QList>
+#include "PatchTable.h"
+#include "Enr.h"
+#include "Rom.h"
+
+namespace patchman
+{
+
+/**
+ * A lug patched differently in two ROMs.
+ */
+struct LugDiff
+{
+    unsigned int rack;
+    unsigned int lug;
+    /** Circuit number for @ref lug, as the rack is conventionally numbered (0-indexed). */
+    unsigned int circuit;
+    /** Lug words (see Rack::getLugWord()). A lug missing from one ROM has a word of 0 there. */
+    uint16_t sourceWord;
+    uint16_t modifiedWord;
+
+    [[nodiscard]] unsigned int getSourceAddress() const
+    {
+        return sourceWord & Rack::kLugWordAddressMask;
+    }
+
+    [[nodiscard]] unsigned int getModifiedAddress() const
+    {
+        return modifiedWord & Rack::kLugWordAddressMask;
+    }
+
+    [[nodiscard]] bool isAddressChanged() const
+    {
+        return getSourceAddress() != getModifiedAddress();
+    }
+
+    [[nodiscard]] unsigned int getSourceAnalog() const
+    {
+        return (sourceWord & EnrRack::kLugWordAnalogMask) >> EnrRack::kLugWordAnalogShift;
+    }
+
+    [[nodiscard]] unsigned int getModifiedAnalog() const
+    {
+        return (modifiedWord & EnrRack::kLugWordAnalogMask) >> EnrRack::kLugWordAnalogShift;
+    }
+
+    [[nodiscard]] bool isAnalogChanged() const
+    {
+        return getSourceAnalog() != getModifiedAnalog();
+    }
+};
+
+/**
+ * Differences between the patch tables of two ROMs.
+ */
+class RomDiff
+{
+public:
+    /**
+     * Compare two patch tables.
+     *
+     * Lugs are compared several at a time, so identical runs of lugs cost a single comparison. The circuit of each
+     * difference is the same as its lug.
+     *
+     * @param source
+     * @param modified
+     */
+    [[nodiscard]] static RomDiff compare(const PatchTableView &source, const PatchTableView &modified);
+
+    /**
+     * Compare two ROMs, numbering differences by circuit.
+     *
+     * @param source
+     * @param modified
+     */
+    [[nodiscard]] static RomDiff compare(const Rom &source, const Rom &modified);
+
+    [[nodiscard]] bool isEmpty() const
+    {
+        return lugDiffs_.empty() && !isRomTypeChanged();
+    }
+
+    [[nodiscard]] bool isRomTypeChanged() const
+    {
+        return sourceRomType_ != modifiedRomType_;
+    }
+
+    /**
+     * Differences, ordered by rack and lug.
+     */
+    [[nodiscard]] const QList<LugDiff> &getLugDiffs() const
+    {
+        return lugDiffs_;
+    }
+
+private:
+    int sourceRomType_ = 0;
+    int modifiedRomType_ = 0;
+    QList<LugDiff> lugDiffs_;
+};
+
+} // patchman
+
+#endif //ROMDIFF_H
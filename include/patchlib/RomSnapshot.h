@@ -0,0 +1,91 @@
+/**
+ * @file RomSnapshot.h
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#ifndef ROMSNAPSHOT_H
+#define ROMSNAPSHOT_H
+
+#include <QByteArray>
+#include <QExplicitlySharedDataPointer>
+#include <QSharedData>
+#include <utility>
+#include "PatchTable.h"
+
+namespace patchman
+{
+
+class Rom;
+
+/**
+ * Immutable copy of a ROM's patch as it was at one edit version.
+ *
+ * Snapshots are implicitly shared, so copying one is cheap, and they may be read from any thread while the ROM they
+ * came from is being edited. Get one from Rom::getSnapshot().
+ */
+class RomSnapshot
+{
+    friend Rom;
+public:
+    /**
+     * Create a null snapshot.
+     */
+    RomSnapshot() = default;
+
+    [[nodiscard]] bool isNull() const
+    {
+        return !d_;
+    }
+
+    /**
+     * The Rom::getEditVersion() this snapshot was taken at.
+     */
+    [[nodiscard]] quint64 getEditVersion() const
+    {
+        return d_ ? d_->editVersion : 0;
+    }
+
+    /**
+     * Get the patch table (see Rom::toPatchTable()). This is a shallow copy.
+     */
+    [[nodiscard]] QByteArray getPatchTable() const
+    {
+        return d_ ? d_->patchTable : QByteArray();
+    }
+
+    /**
+     * Get a view of the patch table, valid for as long as this snapshot.
+     */
+    [[nodiscard]] PatchTableView getPatchTableView() const;
+
+    /**
+     * Create a new, editable ROM with this snapshot's patch.
+     *
+     * @param parent
+     * @return
+     */
+    [[nodiscard]] Rom *toRom(QObject *parent = nullptr) const;
+
+private:
+    struct Data: public QSharedData
+    {
+        Data(quint64 editVersion, QByteArray patchTable)
+            : editVersion(editVersion), patchTable(std::move(patchTable))
+        {}
+
+        const quint64 editVersion;
+        const QByteArray patchTable;
+    };
+    QExplicitlySharedDataPointer<const Data> d_;
+
+    RomSnapshot(quint64 editVersion, QByteArray patchTable)
+        : d_(new Data(editVersion, std::move(patchTable)))
+    {}
+};
+
+} // patchman
+
+#endif //ROMSNAPSHOT_H
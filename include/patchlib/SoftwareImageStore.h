@@ -0,0 +1,75 @@
+/**
+ * @file SoftwareImageStore.h
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#ifndef SOFTWAREIMAGESTORE_H
+#define SOFTWAREIMAGESTORE_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QHash>
+#include <mutex>
+
+namespace patchman
+{
+
+/**
+ * Process-wide store of ROM software images, keyed by their SHA-256 hash. The key is always the hash of exactly the
+ * stored bytes.
+ *
+ * Many ROMs carry identical software. Interning it means every ROM holds a shallow copy of the same QByteArray.
+ * This class is thread-safe.
+ */
+class SoftwareImageStore
+{
+public:
+    static SoftwareImageStore &get();
+
+    /**
+     * Get the stored image with @p hash, adding a copy of @p data if there isn't one.
+     *
+     * @param data The software image.
+     * @param hash SHA-256 of @p data.
+     * @return A shallow copy of the stored image.
+     */
+    [[nodiscard]] QByteArray intern(QByteArrayView data, const QByteArray &hash);
+
+    /**
+     * Get the image stored from @p size bytes at @p pos in the embedded resource at @p path.
+     *
+     * Uncompressed resources are referenced in place, without copying them.
+     *
+     * @param path
+     * @param hash SHA-256 of the @p size bytes at @p pos, not of the whole resource.
+     * @param pos
+     * @param size
+     * @return A shallow copy of the stored image, or an empty array if the resource does not exist or is too small.
+     */
+    [[nodiscard]] QByteArray internResource(const QString &path, const QByteArray &hash, qsizetype pos,
+                                            qsizetype size);
+
+    /**
+     * Get the stored image with @p hash.
+     *
+     * @param hash
+     * @return A shallow copy of the stored image, or an empty array if none is stored.
+     */
+    [[nodiscard]] QByteArray find(const QByteArray &hash) const;
+
+    [[nodiscard]] qsizetype size() const;
+
+private:
+    mutable std::mutex mutex_;
+    QHash<QByteArray, QByteArray> images_;
+
+    explicit SoftwareImageStore() = default;
+    Q_DISABLE_COPY_MOVE(SoftwareImageStore)
+};
+
+} // patchman
+
+#endif //SOFTWAREIMAGESTORE_H
@@ -0,0 +1,94 @@
+/**
+ * @file LibraryWatcher.h
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#ifndef LIBRARYWATCHER_H
+#define LIBRARYWATCHER_H
+
+#include <QObject>
+#include <QFileSystemWatcher>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
+
+namespace patchman
+{
+
+/**
+ * Watch ROM search paths, including all of their subdirectories, for changes.
+ *
+ * Directory trees are walked in the background and watched as they are discovered. When a directory changes, only
+ * its immediate children are examined, so only new subdirectories are walked. Directories the system refuses to
+ * watch (usually because the watch limit is exhausted) are polled for mtime changes instead, backing off while
+ * nothing changes.
+ */
+class LibraryWatcher: public QObject
+{
+Q_OBJECT
+public:
+    explicit LibraryWatcher(QObject *parent = nullptr);
+
+    /**
+     * Replace everything being watched with the trees under @p rootPaths.
+     *
+     * @param rootPaths
+     */
+    void setRootPaths(const QStringList &rootPaths);
+
+    /**
+     * Number of directories being polled instead of watched.
+     */
+    [[nodiscard]] qsizetype getPolledCount() const
+    {
+        return polled_.size();
+    }
+
+Q_SIGNALS:
+    /**
+     * Emitted once after a burst of changes anywhere under the root paths.
+     */
+    void changed();
+
+private:
+    static constexpr int kChangedDelay = 500;
+    static constexpr int kMinPollInterval = 2000;
+    static constexpr int kMaxPollInterval = 60000;
+    using DirWalkWatcher = QFutureWatcher<QStringList>;
+    using PollWatcher = QFutureWatcher<QHash<QString, qint64>>;
+    QFileSystemWatcher *fsWatcher_;
+    QStringList rootPaths_;
+    QSet<QString> known_;
+    QList<DirWalkWatcher *> walks_;
+    /** Polled directory path to its last seen mtime. */
+    QHash<QString, qint64> polled_;
+    QTimer *pollTimer_;
+    PollWatcher *pollWatcher_;
+    QTimer *changedTimer_;
+
+    /**
+     * Walk @p path and all subdirectories in the background, watching directories as they are found.
+     */
+    void walk(const QString &path);
+    void watch(const QStringList &dirs);
+    void unwatchTree(const QString &path);
+    [[nodiscard]] bool isUnderRoot(const QString &path) const;
+
+    /**
+     * Get the mtime of each directory in @p paths, or -1 if it no longer exists.
+     */
+    static QHash<QString, qint64> statDirs(const QStringList &paths);
+
+private Q_SLOTS:
+    void directoryChanged(const QString &path);
+    void poll();
+    void pollFinished();
+};
+
+} // patchman
+
+#endif //LIBRARYWATCHER_H
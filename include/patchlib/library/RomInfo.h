@@ -22,13 +22,14 @@ public:
     friend bool operator==(const RomInfo &lhs, const RomInfo &rhs)
     {
         return lhs.filePath_ == rhs.filePath_ &&
-            lhs.fileMTime_ == rhs.fileMTime_ &&
+            lhs.fileMTimeNs_ == rhs.fileMTimeNs_ &&
             lhs.hashAlgo_ == rhs.hashAlgo_ &&
             lhs.softwareHash_ == rhs.softwareHash_ &&
             lhs.patchHash_ == rhs.patchHash_ &&
             lhs.romType_ == rhs.romType_ &&
             lhs.rackCount_ == rhs.rackCount_ &&
-            lhs.romChecksum_ == rhs.romChecksum_;
+            lhs.romChecksum_ == rhs.romChecksum_ &&
+            lhs.signature_ == rhs.signature_;
     }
 
     friend bool operator!=(const RomInfo &lhs, const RomInfo &rhs)
@@ -39,11 +40,77 @@ public:
 public:
     constexpr static const auto kTable = "rom_info";
 
+    /**
+     * Directories containing ROMs. File paths are split into a directory id and a file name so the (large) directory
+     * part is only stored once.
+     */
+    constexpr static const auto kDirTable = "rom_dir";
+    constexpr static const auto kColDirPath = "path";
+
+    /**
+     * Compressed patch tables (see Rom::toPatchTable()), so ROMs can be shown without reading their files.
+     */
+    constexpr static const auto kPatchTable = "rom_patch";
+    constexpr static const auto kColRomId = "rom_id";
+    constexpr static const auto kColPatchTable = "patch_table";
+
+    /**
+     * Index of DMX addresses to the lugs patched to them, for searching the whole library by address.
+     */
+    constexpr static const auto kPatchIndexTable = "patch_index";
+    constexpr static const auto kColAddress = "address";
+    constexpr static const auto kColRack = "rack";
+    constexpr static const auto kColLug = "lug";
+    constexpr static const auto kColCircuit = "circuit";
+
+    /**
+     * Locality-sensitive hash bands of each ROM's similarity signature, for finding near-duplicates without comparing
+     * every pair of ROMs. See RomSimilarity.
+     */
+    constexpr static const auto kLshTable = "rom_lsh";
+    constexpr static const auto kColBandHash = "band_hash";
+
+    /**
+     * Cached similarity of each pair of comparable ROMs (see RomLibrary::getSimilarityMatrix()). Rows are removed when
+     * either ROM changes.
+     */
+    constexpr static const auto kSimilarityTable = "rom_similarity";
+    constexpr static const auto kColRomA = "rom_a";
+    constexpr static const auto kColRomB = "rom_b";
+    constexpr static const auto kColSimilarity = "similarity";
+
     [[nodiscard]] static QList<QSqlQuery> getDDL();
-    void bind(QSqlQuery &q, int pos);
-    [[nodiscard]] static RomInfo hydrate(QSqlQuery &q);
 
-    constexpr static const auto kColFilePath = "file_path";
+    /**
+     * Get the SELECT statement used to load RomInfo objects, without a WHERE clause.
+     *
+     * Columns are returned in the order hydrate() expects them.
+     */
+    [[nodiscard]] static QString getSelectSql();
+
+    /**
+     * Bind the data columns (kDataColumns) to @p q, starting at @p pos.
+     */
+    void bind(QSqlQuery &q, int pos) const;
+    [[nodiscard]] static RomInfo hydrate(const QSqlQuery &q);
+
+    /**
+     * Normalize a file or directory name so the same file is always stored with the same key.
+     */
+    [[nodiscard]] static QString normalizePath(const QString &path);
+
+    constexpr static const auto kColId = "id";
+
+    /**
+     * The database row id, or 0 if this has not been stored.
+     */
+    [[nodiscard]] qint64 getId() const
+    {
+        return id_;
+    }
+
+    constexpr static const auto kColDirId = "dir_id";
+    constexpr static const auto kColFileName = "file_name";
 
     [[nodiscard]] const QString &getFilePath() const
     {
@@ -57,14 +124,29 @@ public:
 
     constexpr static const auto kColFileMTime = "file_mtime";
 
-    [[nodiscard]] const QDateTime &getFileMTime() const
+    [[nodiscard]] QDateTime getFileMTime() const
     {
-        return fileMTime_;
+        return QDateTime::fromMSecsSinceEpoch(fileMTimeNs_ / 1'000'000).toUTC();
     }
 
     void setFileMTime(const QDateTime &fileMTime)
     {
-        fileMTime_ = fileMTime.toUTC();
+        // Qt only exposes millisecond precision. Storing nanoseconds leaves room for a higher-resolution source without
+        // changing the schema.
+        fileMTimeNs_ = fileMTime.toMSecsSinceEpoch() * 1'000'000;
+    }
+
+    /**
+     * Modification time, in nanoseconds since the Unix epoch.
+     */
+    [[nodiscard]] qint64 getFileMTimeNs() const
+    {
+        return fileMTimeNs_;
+    }
+
+    void setFileMTimeNs(qint64 fileMTimeNs)
+    {
+        fileMTimeNs_ = fileMTimeNs;
     }
 
     constexpr static const auto kColHashAlgo = "hash_algo";
@@ -139,8 +221,25 @@ public:
         romChecksum_ = romChecksum;
     }
 
-    inline static const QStringList kAllColumns{
-        kColFilePath,
+    constexpr static const auto kColSignature = "signature";
+
+    /**
+     * MinHash signature of the patch table (see RomSimilarity::signature()).
+     */
+    [[nodiscard]] const QByteArray &getSignature() const
+    {
+        return signature_;
+    }
+
+    void setSignature(const QByteArray &signature)
+    {
+        signature_ = signature;
+    }
+
+    /**
+     * Columns written by bind().
+     */
+    inline static const QStringList kDataColumns{
         kColFileMTime,
         kColHashAlgo,
         kColSoftwareHash,
@@ -148,17 +247,20 @@ public:
         kColRomType,
         kColRackCount,
         kColRomChecksum,
+        kColSignature,
     };
 
 private:
+    qint64 id_ = 0;
     QString filePath_;
-    QDateTime fileMTime_;
+    qint64 fileMTimeNs_ = 0;
     int hashAlgo_;
     QByteArray softwareHash_;
     QByteArray patchHash_;
     int romType_;
     unsigned int rackCount_;
     QByteArray romChecksum_;
+    QByteArray signature_;
 };
 
 } // patchman
@@ -11,20 +11,77 @@
 
 #include <QObject>
 #include <QFuture>
+#include <QHash>
+#include <QThreadPool>
+#include <QtSql/QSqlDatabase>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include "RomInfo.h"
 
+class RomLibraryFixture;
+
 namespace patchman
 {
 
+/**
+ * A lug patched to a searched DMX address.
+ */
+struct AddressMatch
+{
+    /** RomInfo::getId() of the ROM. */
+    qint64 romId;
+    unsigned int rack;
+    unsigned int lug;
+    unsigned int circuit;
+};
+
+/**
+ * A ROM with a patch table close to another's.
+ */
+struct SimilarRom
+{
+    RomInfo romInfo;
+    /** Number of lugs patched differently. */
+    unsigned int lugEdits;
+};
+
+/**
+ * Similarity of two ROMs of the same type and rack count.
+ */
+struct RomPairSimilarity
+{
+    /** RomInfo::getId() of each ROM. */
+    qint64 lhs;
+    qint64 rhs;
+    /** See RomSimilarity::similarity(). */
+    double similarity;
+};
+
 /**
  * Store information about ROMs in a database.
  *
  * The path to the stored library is in the user's AppData directory, or from the env var PATCHMAN_DB_PATH if set.
+ *
+ * Writes happen on a single thread. Read-only queries run on a separate pool with their own connections, so they are
+ * not blocked behind a long scan.
  */
 class RomLibrary: public QObject
 {
 Q_OBJECT
 public:
+    /**
+     * Scheduling priority for library work. Queued jobs with a higher priority run first.
+     */
+    enum class Priority
+    {
+        Maintenance = 0,
+        Scan = 1,
+        Interactive = 2,
+    };
+
     static RomLibrary *get();
 
     /**
@@ -41,6 +98,9 @@ public:
     /**
      * Update library with contents from paths.
      *
+     * A request identical to a scan that has not started yet shares that scan's future. Otherwise, an unfinished
+     * scan is superseded and cancelled, as only the newest result is useful.
+     *
      * @param searchPaths
      */
     QFuture<QList<RomInfo>> getAllRoms(const QStringList &searchPaths);
@@ -53,16 +113,109 @@ public:
      */
     QFuture<QList<RomInfo>> getDuplicates(const RomInfo &romInfo);
 
+    /**
+     * Find ROMs whose patch tables differ from @p romInfo's in at most @p maxLugEdits lugs.
+     *
+     * Candidates come from the locality-sensitive hash of each ROM's signature, so the whole library is not compared.
+     * Very distant matches may be missed; every returned match is exact.
+     *
+     * @param romInfo
+     * @param maxLugEdits
+     * @return Matches, most similar first. @p romInfo itself is not included.
+     */
+    QFuture<QList<SimilarRom>> getSimilar(const RomInfo &romInfo, unsigned int maxLugEdits);
+
+    /**
+     * Receives the results of getSimilarityMatrix().
+     *
+     * @param pairs One ROM compared with every later ROM in its block.
+     * @param romPaths File path of every ROM being compared, by RomInfo::getId().
+     */
+    using SimilarityConsumer =
+        std::function<void(const QList<RomPairSimilarity> &pairs, const QHash<qint64, QString> &romPaths)>;
+
+    /**
+     * Compare every pair of ROMs in the library that share a ROM type and rack count.
+     *
+     * Comparisons run on a thread of their own and only read the database in short queries, so scans and other reads
+     * are not held up. Results are cached, so only pairs involving new or changed ROMs are compared again. Reports
+     * progress in pairs compared, scaled down if there are more pairs than fit in an int.
+     *
+     * Neither the matrix nor the library's patch tables are held in memory at once; patch tables are loaded a few
+     * hundred at a time, and results are passed to @p consumer as they are ready. @p consumer is called from a worker
+     * thread, one ROM at a time, ordered by ROM.
+     *
+     * @param consumer
+     */
+    QFuture<void> getSimilarityMatrix(SimilarityConsumer consumer);
+
+    /**
+     * Get the stored patch table for @p romInfo.
+     *
+     * @param romInfo
+     * @return The data from Rom::toPatchTable(), or an empty array if the library has no patch table for this ROM.
+     */
+    QFuture<QByteArray> getPatchTable(const RomInfo &romInfo);
+
+    /**
+     * Find every lug in the library patched to @p address.
+     *
+     * @param address DMX address.
+     * @param rack Only search this rack number.
+     * @return Matches, ordered by ROM, rack, and lug.
+     */
+    QFuture<QList<AddressMatch>> findAddress(unsigned int address, std::optional<unsigned int> rack = {});
+
+    /**
+     * Count the ROMs sharing each patch hash.
+     *
+     * @return Map of patch hash to the number of ROMs with that patch table.
+     */
+    QFuture<QHash<QByteArray, unsigned int>> getPatchHashCounts();
+
 private:
+    /** Tests hold the writer to control what is queued behind it. */
+    friend class ::RomLibraryFixture;
+
     /** PTCH */
     static const int32_t kAppId = 0x50544348;
-    static const int32_t kAppVersion = 0;
+    static const int32_t kAppVersion = 6;
+    static const int kReadConnectionCount = 2;
     QThreadPool pool_;
+    QThreadPool readPool_;
+    /** Runs getSimilarityMatrix(), which is too long to hold a read or write thread for. */
+    QThreadPool similarityPool_;
+
+    struct ScanJob
+    {
+        QStringList searchPaths;
+        QFuture<QList<RomInfo>> future;
+        std::shared_ptr<std::atomic_bool> started;
+    };
+    std::mutex lastScanMutex_;
+    std::optional<ScanJob> lastScan_;
 
     explicit RomLibrary(QObject *parent = nullptr);
 
     QFuture<void> open();
 
+    /**
+     * Write newly compared pairs to the similarity cache.
+     */
+    void saveSimilarities(QList<RomPairSimilarity> pairs);
+
+    /**
+     * Pool for read-only queries.
+     *
+     * In-memory databases can't be shared between connections, so reads go through the writer in that case.
+     */
+    [[nodiscard]] QThreadPool *getReadPool();
+
+    /**
+     * Get the database connection for a read-only query on the current thread, opening it if needed.
+     */
+    static QSqlDatabase getReadDatabase();
+
     static QString getDbPath();
 };
 
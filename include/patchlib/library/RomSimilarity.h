@@ -0,0 +1,70 @@
+/**
+ * @file RomSimilarity.h
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#ifndef ROMSIMILARITY_H
+#define ROMSIMILARITY_H
+
+#include <QByteArray>
+#include <QList>
+#include "patchlib/PatchTable.h"
+
+namespace patchman::RomSimilarity
+{
+
+/**
+ * Number of MinHash values in a signature.
+ */
+constexpr unsigned int kHashCount = 32;
+
+/**
+ * Signatures are split into this many bands for locality-sensitive hashing. Two ROMs become candidates when any band
+ * is identical.
+ */
+constexpr unsigned int kBandCount = 8;
+constexpr unsigned int kRowsPerBand = kHashCount / kBandCount;
+static_assert(kBandCount * kRowsPerBand == kHashCount);
+
+/**
+ * Compute the MinHash signature of a patch table.
+ *
+ * Each lug contributes one element (rack, lug, lug word), so the signatures of two patch tables agree in proportion to
+ * how many lugs they have in common.
+ *
+ * @param patchTable
+ * @return kHashCount little-endian 32-bit values.
+ */
+[[nodiscard]] QByteArray signature(const PatchTableView &patchTable);
+
+/**
+ * Get the hash of each band in @p signature.
+ *
+ * @param signature From signature().
+ * @return kBandCount values, or nothing if @p signature is not valid.
+ */
+[[nodiscard]] QList<qint64> bandHashes(const QByteArray &signature);
+
+/**
+ * Count the lugs that differ between two patch tables.
+ *
+ * Lugs that only exist in one table count as different unless they are unpatched.
+ */
+[[nodiscard]] unsigned int countLugEdits(const PatchTableView &lhs, const PatchTableView &rhs);
+
+/**
+ * Rack-level similarity of two patch tables.
+ *
+ * Only lugs patched in either table are compared, and racks unpatched in both are skipped.
+ *
+ * @return The fraction of identical patched lugs in each rack, averaged over racks patched in either table: 1 when the
+ *  tables are identical, 0 when no patched lug matches.
+ */
+[[nodiscard]] double similarity(const PatchTableView &lhs, const PatchTableView &rhs);
+
+} // patchman::RomSimilarity
+
+#endif //ROMSIMILARITY_H
@@ -8,6 +8,7 @@
 
 #include "patchlib/D192.h"
 #include "patchlib/Exceptions.h"
+#include "patchlib/RackDescriptor.h"
 #include <source_location>
 #include <frozen/unordered_map.h>
 #include <QCryptographicHash>
@@ -15,15 +16,6 @@
 namespace patchman
 {
 
-/**
- * The number of lugs in each rack getType.
- */
-constexpr auto kLugCounts = frozen::make_unordered_map<Rack::Type, unsigned int>(
-    {
-        {Rack::Type::D192Rack, 192},
-    }
-);
-
 /**
  * Two different kinds of ROMs used for patch info.
  */
@@ -43,400 +35,6 @@ constexpr auto kRomSizes = frozen::make_unordered_map<RomChip, unsigned int>(
     }
 );
 
-constexpr auto kCircuitToLugMap = std::to_array(
-    {
-        0,
-        1,
-        64,
-        65,
-        128,
-        129,
-        2,
-        3,
-        66,
-        67,
-        130,
-        131,
-        4,
-        5,
-        68,
-        69,
-        132,
-        133,
-        6,
-        7,
-        70,
-        71,
-        134,
-        135,
-        8,
-        9,
-        72,
-        73,
-        136,
-        137,
-        10,
-        11,
-        74,
-        75,
-        138,
-        139,
-        12,
-        13,
-        76,
-        77,
-        140,
-        141,
-        14,
-        15,
-        78,
-        79,
-        142,
-        143,
-        16,
-        17,
-        80,
-        81,
-        144,
-        145,
-        18,
-        19,
-        82,
-        83,
-        146,
-        147,
-        20,
-        21,
-        84,
-        85,
-        148,
-        149,
-        22,
-        23,
-        86,
-        87,
-        150,
-        151,
-        24,
-        25,
-        88,
-        89,
-        152,
-        153,
-        26,
-        27,
-        90,
-        91,
-        154,
-        155,
-        28,
-        29,
-        92,
-        93,
-        156,
-        157,
-        30,
-        31,
-        94,
-        95,
-        158,
-        159,
-        32,
-        33,
-        96,
-        97,
-        160,
-        161,
-        34,
-        35,
-        98,
-        99,
-        162,
-        163,
-        36,
-        37,
-        100,
-        101,
-        164,
-        165,
-        38,
-        39,
-        102,
-        103,
-        166,
-        167,
-        40,
-        41,
-        104,
-        105,
-        168,
-        169,
-        42,
-        43,
-        106,
-        107,
-        170,
-        171,
-        44,
-        45,
-        108,
-        109,
-        172,
-        173,
-        46,
-        47,
-        110,
-        111,
-        174,
-        175,
-        48,
-        49,
-        112,
-        113,
-        176,
-        177,
-        50,
-        51,
-        114,
-        115,
-        178,
-        179,
-        52,
-        53,
-        116,
-        117,
-        180,
-        181,
-        54,
-        55,
-        118,
-        119,
-        182,
-        183,
-        56,
-        57,
-        120,
-        121,
-        184,
-        185,
-        58,
-        59,
-        122,
-        123,
-        186,
-        187,
-        60,
-        61,
-        124,
-        125,
-        188,
-        189,
-        62,
-        63,
-        126,
-        127,
-        190,
-        191,
-    }
-);
-
-constexpr auto kLugToCircuitMap = std::to_array(
-    {
-        0,
-        1,
-        6,
-        7,
-        12,
-        13,
-        18,
-        19,
-        24,
-        25,
-        30,
-        31,
-        36,
-        37,
-        42,
-        43,
-        48,
-        49,
-        54,
-        55,
-        60,
-        61,
-        66,
-        67,
-        72,
-        73,
-        78,
-        79,
-        84,
-        85,
-        90,
-        91,
-        96,
-        97,
-        102,
-        103,
-        108,
-        109,
-        114,
-        115,
-        120,
-        121,
-        126,
-        127,
-        132,
-        133,
-        138,
-        139,
-        144,
-        145,
-        150,
-        151,
-        156,
-        157,
-        162,
-        163,
-        168,
-        169,
-        174,
-        175,
-        180,
-        181,
-        186,
-        187,
-        2,
-        3,
-        8,
-        9,
-        14,
-        15,
-        20,
-        21,
-        26,
-        27,
-        32,
-        33,
-        38,
-        39,
-        44,
-        45,
-        50,
-        51,
-        56,
-        57,
-        62,
-        63,
-        68,
-        69,
-        74,
-        75,
-        80,
-        81,
-        86,
-        87,
-        92,
-        93,
-        98,
-        99,
-        104,
-        105,
-        110,
-        111,
-        116,
-        117,
-        122,
-        123,
-        128,
-        129,
-        134,
-        135,
-        140,
-        141,
-        146,
-        147,
-        152,
-        153,
-        158,
-        159,
-        164,
-        165,
-        170,
-        171,
-        176,
-        177,
-        182,
-        183,
-        188,
-        189,
-        4,
-        5,
-        10,
-        11,
-        16,
-        17,
-        22,
-        23,
-        28,
-        29,
-        34,
-        35,
-        40,
-        41,
-        46,
-        47,
-        52,
-        53,
-        58,
-        59,
-        64,
-        65,
-        70,
-        71,
-        76,
-        77,
-        82,
-        83,
-        88,
-        89,
-        94,
-        95,
-        100,
-        101,
-        106,
-        107,
-        112,
-        113,
-        118,
-        119,
-        124,
-        125,
-        130,
-        131,
-        136,
-        137,
-        142,
-        143,
-        148,
-        149,
-        154,
-        155,
-        160,
-        161,
-        166,
-        167,
-        172,
-        173,
-        178,
-        179,
-        184,
-        185,
-        190,
-        191,
-    }
-);
-
 D192Rom::D192Rom(QObject *parent)
     : Rom(parent)
 {
@@ -448,35 +46,9 @@ D192Rom::D192Rom(QObject *parent)
     }
 }
 
-Phase patchman::D192Rack::getPhaseForLug(unsigned int lug) const
-{
-    if (getRackType() == Rack::Type::D192Rack) {
-        if (lug < 64) {
-            return Phase::A;
-        }
-        else if (lug < 128) {
-            return Phase::B;
-        }
-        else {
-            return Phase::C;
-        }
-    }
-    Q_UNREACHABLE();
-}
-
-unsigned int D192Rack::getLugForCircuit(unsigned int circuit) const
-{
-    return kCircuitToLugMap.at(circuit);
-}
-
-unsigned int D192Rack::getCircuitForLug(unsigned int lug) const
-{
-    return kLugToCircuitMap.at(lug);
-}
-
 void D192Rack::initLugAddressMap()
 {
-    lugAddresses_.fill(0, kLugCounts.at(getRackType()));
+    initLugWords(getRackDescriptor(getRackType()).lugCount);
 }
 
 Rack *D192Rom::addRack(unsigned int rackNum, Rack::Type rackType)
@@ -500,20 +72,21 @@ void D192Rack::fromByteArray(QByteArrayView data)
     for (unsigned int address = 1; address <= data.size(); ++address) {
         const uint8_t lug = data.at(address - 1);
         if (lug != 0xFF) {
-            if (lug >= kLugCounts.at(getRackType())) {
+            if (lug >= lugCount_) {
                 throw InvalidRomException(tr("Lug number out of range."),
                                           tr("Either this is not a D192 ROM or the file is corrupt."));
             }
-            lugAddresses_[lug] = address;
+            lugWords_[lug] = address;
         }
     }
+    markChanged();
 }
 
 QByteArray D192Rack::toByteArray() const
 {
     QByteArray data(512, -1);
-    for (uint8_t lug = 0; lug < lugAddresses_.size(); ++lug) {
-        const auto address = lugAddresses_.at(lug);
+    for (unsigned int lug = 0; lug < lugCount_; ++lug) {
+        const auto address = lugWords_[lug] & kLugWordAddressMask;
         if (address == 0) {
             continue;
         }
@@ -524,56 +97,6 @@ QByteArray D192Rack::toByteArray() const
     return data;
 }
 
-unsigned int D192Rack::getLugCount() const
-{
-    return static_cast<unsigned int>(kLugToCircuitMap.size());
-}
-
-unsigned int D192Rack::getLugsPerModule() const
-{
-    return 2;
-}
-
-unsigned int D192Rack::getModuleDensityForLug(unsigned int lug) const
-{
-    // Get the lugs in this slot.
-    unsigned int lugA, lugB;
-    if (lug % 2 == 0) {
-        lugA = lug;
-        lugB = lug + 1;
-    }
-    else {
-        lugA = lug - 1;
-        lugB = lug;
-    }
-
-    const auto lugAAddr = getLugAddress(lugA);
-    const auto lugBAddr = getLugAddress(lugB);
-
-    if (lugAAddr == 0 && lugBAddr == 0) {
-        // Blank module
-        return 0;
-    }
-    else if (lugAAddr != 0 && lugBAddr != 0) {
-        return 2;
-    }
-    else {
-        return 1;
-    }
-}
-QString D192Rack::getModuleNameForLug(unsigned int lug) const
-{
-    const auto density = getModuleDensityForLug(lug);
-
-    switch (density) {
-        case 0:return tr("Blank");
-        case 1:return tr("6 kW");
-        case 2:return tr("1.2/2.4 kW");
-        default:return Rack::getModuleNameForLug(lug);
-    }
-    Q_UNREACHABLE();
-}
-
 bool D192Rom::isD192Rom(QByteArrayView data)
 {
     // Patch EPROMs are 2716 (usually) or 2732 (big systems).
@@ -0,0 +1,306 @@
+/**
+ * @file EditJournal.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#include "patchlib/EditJournal.h"
+#include "patchlib/Exceptions.h"
+#include <QDebug>
+#include <QDir>
+#include <QStandardPaths>
+#include <QtEndian>
+#include <QUuid>
+#include <algorithm>
+#include <memory>
+#include <optional>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace patchman
+{
+
+/*
+ * Journal layout, all integers little-endian:
+ *
+ * Header:
+ *   "PMJ1"
+ *   u32 ROM path length, ROM path (UTF-8)
+ *   u32 ROM image length, ROM image
+ * Then any number of records:
+ *   u16 rack number
+ *   u8 first lug
+ *   u8 lug count
+ *   u16 lug word (see Rack::getLugWord()) for each lug
+ *
+ * A crash can leave the last record incomplete; it is ignored when recovering.
+ */
+static constexpr char kJournalMagic[] = "PMJ1";
+static constexpr qsizetype kJournalMagicSize = sizeof(kJournalMagic) - 1;
+static constexpr qsizetype kRecordHeaderSize = 4;
+
+template<typename T>
+static void appendLittleEndian(QByteArray &data, T value)
+{
+    const auto le = qToLittleEndian(value);
+    data.append(reinterpret_cast<const char *>(&le), sizeof(le));
+}
+
+/**
+ * Read a length-prefixed block from @p data at @p pos, advancing @p pos past it.
+ */
+static std::optional<QByteArrayView> readBlock(QByteArrayView data, qsizetype &pos)
+{
+    if (data.size() - pos < static_cast<qsizetype>(sizeof(quint32))) {
+        return {};
+    }
+    const auto size = qFromLittleEndian<quint32>(data.data() + pos);
+    pos += sizeof(quint32);
+    if (data.size() - pos < static_cast<qsizetype>(size)) {
+        return {};
+    }
+    const auto block = data.sliced(pos, size);
+    pos += size;
+    return block;
+}
+
+/**
+ * Write buffered data in @p file to the disk, not only the OS cache.
+ */
+static bool syncFile(QFile &file)
+{
+    if (!file.flush()) {
+        return false;
+    }
+#ifdef Q_OS_WIN
+    return _commit(file.handle()) == 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+
+EditJournal::EditJournal(Rom *rom, const QString &journalPath, QObject *parent)
+    : QObject(parent),
+      rom_(rom),
+      file_(journalPath),
+      lock_(std::make_unique<QLockFile>(journalPath + ".lock")),
+      flushTimer_(new QTimer(this))
+{
+    // Bound how long an edit can wait to reach the disk without restarting the wait on every edit.
+    flushTimer_->setSingleShot(true);
+    flushTimer_->setInterval(kFlushDelay);
+    connect(flushTimer_, &QTimer::timeout, this, &EditJournal::flush);
+}
+
+EditJournal::~EditJournal()
+{
+    flush();
+}
+
+EditJournal *EditJournal::create(Rom *rom, const QString &romPath, QObject *parent)
+{
+    const QDir journalDir(getJournalDir());
+    if (!journalDir.mkpath(".")) {
+        qWarning() << "Unable to create journal directory" << journalDir.path();
+        return nullptr;
+    }
+    const auto journalPath = journalDir.filePath(QUuid::createUuid().toString(QUuid::WithoutBraces) + ".journal");
+    std::unique_ptr<EditJournal> journal(new EditJournal(rom, journalPath, parent));
+    journal->lock_->setStaleLockTime(0);
+    if (!journal->lock_->tryLock(0) || !journal->file_.open(QFile::WriteOnly | QFile::Truncate)) {
+        qWarning() << "Unable to create journal" << journalPath;
+        return nullptr;
+    }
+    try {
+        journal->writeHeader(romPath);
+    }
+    catch (const std::runtime_error &e) {
+        qWarning() << "Unable to journal ROM:" << e.what();
+        journal->discard();
+        return nullptr;
+    }
+
+    for (auto *rack : rom->getRacksView()) {
+        journal->track(rack);
+    }
+    connect(rom, &Rom::rackAdded, journal.get(), &EditJournal::track);
+
+    return journal.release();
+}
+
+void EditJournal::flush()
+{
+    flushTimer_->stop();
+    if (pending_.isEmpty() || !file_.isOpen()) {
+        return;
+    }
+    if (file_.write(pending_) != pending_.size() || !syncFile(file_)) {
+        qWarning() << "Unable to write journal" << file_.fileName() << file_.errorString();
+    }
+    pending_.clear();
+}
+
+void EditJournal::reset(const QString &romPath)
+{
+    if (!file_.isOpen()) {
+        return;
+    }
+    flushTimer_->stop();
+    pending_.clear();
+    try {
+        if (!file_.resize(0) || !file_.seek(0)) {
+            throw std::runtime_error(file_.errorString().toStdString());
+        }
+        writeHeader(romPath);
+    }
+    catch (const std::runtime_error &e) {
+        qWarning() << "Unable to reset journal:" << e.what();
+        discard();
+    }
+}
+
+void EditJournal::discard()
+{
+    flushTimer_->stop();
+    pending_.clear();
+    if (file_.isOpen()) {
+        file_.close();
+        file_.remove();
+    }
+    lock_.reset();
+}
+
+QString EditJournal::getJournalDir()
+{
+    // Use an env var for this path to facilitate testing.
+    return qEnvironmentVariable("PATCHMAN_JOURNAL_DIR",
+                                QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation))
+                                    .filePath("journals"));
+}
+
+QStringList EditJournal::findAbandoned()
+{
+    QStringList journalPaths;
+    const QDir journalDir(getJournalDir());
+    for (const auto &fileInfo : journalDir.entryInfoList({"*.journal"}, QDir::Files, QDir::Time | QDir::Reversed)) {
+        // Journals held by a running instance are locked; a crashed instance's lock is stale.
+        QLockFile lock(fileInfo.filePath() + ".lock");
+        lock.setStaleLockTime(0);
+        if (lock.tryLock(0)) {
+            journalPaths.push_back(fileInfo.filePath());
+        }
+    }
+    return journalPaths;
+}
+
+EditJournal::Recovered EditJournal::recover(const QString &journalPath, QObject *parent)
+{
+    QFile file(journalPath);
+    if (!file.open(QFile::ReadOnly)) {
+        throw InvalidRomException(tr("The journal could not be read."), file.errorString());
+    }
+    const auto data = file.readAll();
+    const QByteArrayView dataView(data);
+
+    qsizetype pos = kJournalMagicSize;
+    if (!dataView.startsWith(QByteArrayView(kJournalMagic, kJournalMagicSize))) {
+        throw InvalidRomException(tr("This is not a journal file."));
+    }
+    const auto romPath = readBlock(dataView, pos);
+    const auto image = readBlock(dataView, pos);
+    if (!romPath || !image) {
+        throw InvalidRomException(tr("The journal is incomplete."));
+    }
+
+    std::unique_ptr<Rom> rom(Rom::create(Rom::guessType(*image), parent));
+    rom->loadFromData(*image);
+    while (dataView.size() - pos >= kRecordHeaderSize) {
+        const auto rackNum = qFromLittleEndian<quint16>(dataView.data() + pos);
+        const auto firstLug = static_cast<quint8>(dataView[pos + 2]);
+        const auto lugCount = static_cast<quint8>(dataView[pos + 3]);
+        pos += kRecordHeaderSize;
+        if (dataView.size() - pos < static_cast<qsizetype>(lugCount * sizeof(uint16_t))) {
+            // Interrupted while writing this record.
+            break;
+        }
+        const auto racks = rom->getRacksView();
+        const auto rackIt = std::ranges::find_if(racks, [rackNum](const Rack *rack)
+        {
+            return rack->getRackNum() == rackNum;
+        });
+        auto *rack = rackIt == racks.end() ? nullptr : *rackIt;
+        if (rack == nullptr || firstLug + lugCount > rack->getLugCount()) {
+            qWarning() << "Journal" << journalPath << "has an edit for a lug not in the ROM; ignoring the rest.";
+            break;
+        }
+        for (unsigned int lug = firstLug; lug < firstLug + lugCount; ++lug) {
+            rack->setLugWord(lug, qFromLittleEndian<uint16_t>(dataView.data() + pos));
+            pos += sizeof(uint16_t);
+        }
+    }
+
+    return {.romPath = QString::fromUtf8(*romPath), .rom = rom.release()};
+}
+
+void EditJournal::remove(const QString &journalPath)
+{
+    QFile::remove(journalPath);
+}
+
+void EditJournal::writeHeader(const QString &romPath)
+{
+    const auto romPathUtf8 = romPath.toUtf8();
+    const auto image = rom_->toByteArray();
+    QByteArray header;
+    header.reserve(kJournalMagicSize + 2 * sizeof(quint32) + romPathUtf8.size() + image.size());
+    header.append(kJournalMagic, kJournalMagicSize);
+    appendLittleEndian<quint32>(header, romPathUtf8.size());
+    header.append(romPathUtf8);
+    appendLittleEndian<quint32>(header, image.size());
+    header.append(image);
+    if (file_.write(header) != header.size() || !syncFile(file_)) {
+        throw std::runtime_error(file_.errorString().toStdString());
+    }
+}
+
+void EditJournal::track(Rack *rack)
+{
+    connect(rack, &Rack::lugChanged, this, [this, rack](unsigned int lug)
+    {
+        append(rack, lug, lug);
+    });
+    connect(rack, &Rack::lugRangeChanged, this, [this, rack](unsigned int firstLug, unsigned int lastLug)
+    {
+        append(rack, firstLug, lastLug);
+    });
+}
+
+void EditJournal::append(const Rack *rack, unsigned int firstLug, unsigned int lastLug)
+{
+    if (!file_.isOpen()) {
+        return;
+    }
+    // Record the resulting words rather than the edit, so undo and redo need nothing special.
+    const auto words = rack->getLugWords().subspan(firstLug, lastLug - firstLug + 1);
+    appendLittleEndian<quint16>(pending_, rack->getRackNum());
+    pending_.append(static_cast<char>(firstLug));
+    pending_.append(static_cast<char>(words.size()));
+    for (const auto word : words) {
+        appendLittleEndian<uint16_t>(pending_, word);
+    }
+
+    if (pending_.size() >= kMaxPendingBytes) {
+        flush();
+    }
+    else if (!flushTimer_->isActive()) {
+        flushTimer_->start();
+    }
+}
+
+} // patchman
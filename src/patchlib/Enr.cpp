@@ -8,10 +8,13 @@
 
 #include "patchlib/Enr.h"
 #include "patchlib/Exceptions.h"
+#include "patchlib/RackDescriptor.h"
+#include "patchlib/SoftwareImageStore.h"
 #include <frozen/unordered_map.h>
 #include <frozen/string.h>
 #include <QtEndian>
 #include <source_location>
+#include <algorithm>
 #include <QCryptographicHash>
 #include <QDebug>
 #include <QFile>
@@ -24,11 +27,8 @@ constexpr auto kPatchTableCount = 16;
 
 constexpr auto kPatchTableStart = 0x3000;
 
-constexpr auto kLugCounts = frozen::make_unordered_map<Rack::Type, unsigned int>(
-    {
-        {Rack::Type::Enr96, 96},
-    }
-);
+constexpr auto kPatchTableEnd =
+    kPatchTableStart + kPatchTableCount * RackTraits<Rack::Type::Enr96>::kDescriptor.lugCount * 2;
 
 constexpr auto kRomSizes = frozen::make_unordered_map<Rack::Type, unsigned int>(
     {
@@ -56,6 +56,12 @@ static const auto kSoftwareChecksums = frozen::make_unordered_map<EnrRom::Versio
     }
 );
 
+/**
+ * SHA-256 of the bytes after the patch tables, which are the same in every embedded software version.
+ */
+static const auto kTrailerChecksum =
+    QByteArray::fromHex("191acf143da5e4f52d1bb3434ee136a11652d38d81633d3e10ff4169bbb9a8c1");
+
 static const QHash<EnrRom::Version, QString> kSoftwareFilepaths{
     {EnrRom::Version::EnrRack220, ":/bin/enr/enr_rack_220.bin"},
     {EnrRom::Version::EnrRack230, ":/bin/enr/enr_rack_230.bin"},
@@ -66,141 +72,57 @@ static const QHash<EnrRom::Version, QString> kSoftwareFilepaths{
     {EnrRom::Version::EnrRack294, ":/bin/enr/enr_rack_294.bin"},
 };
 
-unsigned int EnrRack::getLugCount() const
-{
-    switch (getRackType()) {
-        case Type::Enr96:return 96;
-        default:Q_UNREACHABLE();
-    }
-    Q_UNREACHABLE();
-}
-
-unsigned int EnrRack::getLugsPerModule() const
-{
-    return 2;
-}
-
-unsigned int EnrRack::getModuleDensityForLug(unsigned int lug) const
-{
-    // Get the lugs in this slot.
-    unsigned int lugA, lugB;
-    if (lug % 2 == 0) {
-        lugA = lug;
-        lugB = lug + 1;
-    }
-    else {
-        lugA = lug - 1;
-        lugB = lug;
-    }
-
-    const auto lugAAddr = getLugAddress(lugA);
-    const auto lugBAddr = getLugAddress(lugB);
-
-    if (lugAAddr == 0 && lugBAddr == 0) {
-        // Blank module
-        return 0;
-    }
-    else if (lugAAddr != 0 && lugBAddr != 0) {
-        return 2;
-    }
-    else {
-        return 1;
-    }
-}
-
-QString EnrRack::getModuleNameForLug(unsigned int lug) const
-{
-    const auto density = getModuleDensityForLug(lug);
-
-    switch (density) {
-        case 0:return tr("Blank");
-        case 1:return tr("6 kW");
-        case 2:return tr("1.8/2.4 kW");
-        default:return Rack::getModuleNameForLug(lug);
-    }
-    Q_UNREACHABLE();
-}
-
-Phase EnrRack::getPhaseForLug(unsigned int lug) const
-{
-    const auto phase = lug / (getLugCount() / 3);
-    return static_cast<Phase>(phase + 1);
-}
-
 unsigned int EnrRack::getLugAnalogChan(unsigned int lug) const
 {
-    Q_ASSERT_X(lug < lugAddresses_.size(),
-               std::source_location::current().function_name(),
-               "Tried to get lug not in rack.");
-    return lugAnalog_.at(lug);
+    return (getLugWord(lug) & kLugWordAnalogMask) >> kLugWordAnalogShift;
 }
 
 void EnrRack::setLugAnalogChan(unsigned int lug, unsigned int chan)
 {
-    Q_ASSERT_X(lug < lugAddresses_.size(),
+    Q_ASSERT_X(lug < lugCount_,
                std::source_location::current().function_name(),
                "Tried to set lug not in rack.");
     if (chan > kMaxAnalog) {
         return;
     }
-    lugAnalog_[lug] = chan;
+    editLugWords(std::views::single(lug), [chan](unsigned int, uint16_t word)
+    {
+        return (word & ~kLugWordAnalogMask) | (chan << kLugWordAnalogShift);
+    });
     Q_EMIT(lugChanged(lug));
 }
 
 void EnrRack::initLugAddressMap()
 {
-    const auto lugCount = kLugCounts.at(getRackType());
-    lugAddresses_.fill(0, lugCount);
-    lugAnalog_.fill(0, lugCount);
+    initLugWords(getRackDescriptor(getRackType()).lugCount, kLugWordMask);
 }
 
 void EnrRack::fromByteArray(QByteArrayView data)
 {
-    Q_ASSERT_X(lugAddresses_.size() == getLugCount(),
+    Q_ASSERT_X(data.size() >= static_cast<qsizetype>(lugCount_ * sizeof(uint16_t)),
                std::source_location::current().function_name(),
-               "Lug addresses size mismatch.");
-    Q_ASSERT_X(lugAnalog_.size() == getLugCount(),
-               std::source_location::current().function_name(),
-               "Lug analog size mismatch.");
-    // Different from D192. Each table is a list of addresses, stored in lug order.
-    for (unsigned int lug = 0; lug < getLugCount(); ++lug) {
-        const auto dataOffset = lug * 2;
-        Q_ASSERT_X(dataOffset < data.size(),
-                   std::source_location::current().function_name(),
-                   "Tried to load lug patch beyond end of rack");
-        const auto lugData = qFromLittleEndian<uint16_t>(data.data() + dataOffset);
-        const auto address = lugData & 0x03FFu;
-        const auto analog = (lugData & 0xF000u) >> 12;
-        lugAddresses_[lug] = address;
-        lugAnalog_[lug] = analog;
+               "Tried to load lug patch beyond end of rack");
+    // Different from D192. Each table is a list of lug words, stored in lug order; this is the same layout used in
+    // memory.
+    qFromLittleEndian<uint16_t>(data.data(), lugCount_, lugWords_.data());
+    for (auto &word : std::span(lugWords_.data(), lugCount_)) {
+        word &= kLugWordMask;
     }
+    markChanged();
 }
 
 QByteArray EnrRack::toByteArray() const
 {
-    Q_ASSERT_X(lugAddresses_.size() == getLugCount(),
-               std::source_location::current().function_name(),
-               "Lug addresses size mismatch.");
-    Q_ASSERT_X(lugAnalog_.size() == getLugCount(),
-               std::source_location::current().function_name(),
-               "Lug analog size mismatch.");
-    QByteArray data(getLugCount() * 2, 0);
-    for (unsigned int lug = 0; lug < getLugCount(); ++lug) {
-        const auto address = lugAddresses_.at(lug);
-        const auto analog = lugAnalog_.at(lug);
-        const auto lugData = qToLittleEndian<uint16_t>(static_cast<uint16_t>(address) | ((analog & 0x0F) << 12));
-
-        const auto dataOffset = lug * 2;
-        std::memcpy(data.data() + dataOffset, &lugData, 2);
-    }
+    QByteArray data(lugCount_ * sizeof(uint16_t), Qt::Uninitialized);
+    qToLittleEndian<uint16_t>(lugWords_.data(), lugCount_, data.data());
 
     return data;
 }
 
 bool operator==(const EnrRack &lhs, const EnrRack &rhs)
 {
-    return static_cast<const patchman::Rack &>(lhs) == static_cast<const patchman::Rack &>(rhs) &&
-        lhs.lugAnalog_ == rhs.lugAnalog_;
+    // Analog channels are part of the lug words.
+    return static_cast<const patchman::Rack &>(lhs) == static_cast<const patchman::Rack &>(rhs);
 }
 
 const QMap<EnrRom::Version, QString> &EnrRom::getVersionNames()
@@ -220,10 +142,9 @@ const QMap<EnrRom::Version, QString> &EnrRom::getVersionNames()
 }
 
 EnrRom::EnrRom(QObject *parent)
-    : Rom(parent)
+    : Rom(parent), version_(Version::EnrRack294), software_hash_(kSoftwareChecksums.at(Version::EnrRack294))
 {
-    // Load default software.
-    setVersion(Version::EnrRack294);
+    // Default software is loaded when it's first needed; usually loadFromData() replaces it before then.
 
     for (unsigned int rackNum = 0; rackNum < kPatchTableCount; ++rackNum) {
         auto rack = new EnrRack(rackNum, Rack::Type::Enr96, this);
@@ -256,17 +177,14 @@ void EnrRom::setVersion(EnrRom::Version version)
 {
     if (version == Version::Unknown) {
         qWarning() << "Cannot set ENR software version to Unknown.";
+        return;
     }
     version_ = version;
-
-    const auto path = kSoftwareFilepaths.value(version);
-    QFile file(path);
-    file.open(QFile::ReadOnly);
-    Q_ASSERT_X(file.isOpen(),
-               std::source_location::current().function_name(),
-               "Failed to open software version from internal resource.");
-    software_ = file.readAll();
-    software_hash_ = QCryptographicHash::hash(software_, QCryptographicHash::Algorithm::Sha256);
+    // The hash of embedded software is already known, so there's no need to compute it.
+    software_hash_ = kSoftwareChecksums.at(version);
+    software_.clear();
+    trailer_.clear();
+    markChanged();
     Q_EMIT(versionChanged(version_));
     Q_EMIT(titleChanged());
 }
@@ -278,7 +196,7 @@ void EnrRom::loadFromData(QByteArrayView data)
     }
 
     // Guess software version
-    const auto software = data.sliced(0, kPatchTableStart).toByteArray();
+    const auto software = data.sliced(0, kPatchTableStart);
     const auto swHash = QCryptographicHash::hash(software, getHashAlgorithm());
     version_ = Version::Unknown;
     for (const auto &[version, checksum] : kSoftwareChecksums) {
@@ -287,8 +205,18 @@ void EnrRom::loadFromData(QByteArrayView data)
             break;
         }
     }
-    // Hold on to the rom file, the patch table will be spliced in at the end.
-    software_ = software;
+    // Hold on to the software, the patch table will be spliced in at the end. Identical software is shared between
+    // ROMs; known versions use the embedded copy when it's needed, which has the same bytes.
+    auto &store = SoftwareImageStore::get();
+    if (version_ != Version::Unknown) {
+        software_.clear();
+    }
+    else {
+        software_ = store.intern(software, swHash);
+    }
+    // The software hash doesn't cover the bytes after the patch tables, so keep them as loaded.
+    const auto trailer = data.sliced(kPatchTableEnd);
+    trailer_ = store.intern(trailer, QCryptographicHash::hash(trailer, getHashAlgorithm()));
     software_hash_ = swHash;
 
     // Patch tables starts as 0x3000. 16 tables total, 192 bytes per table. Each circuit is 2 bytes little-endian.
@@ -300,7 +228,7 @@ void EnrRom::loadFromData(QByteArrayView data)
             rack = dynamic_cast<EnrRack *>(addRack(rackNum, Rack::Type::Enr96));
         }
         Q_ASSERT_X(rack != nullptr, std::source_location::current().function_name(), "Failed to create new ENR rack.");
-        const auto rackPatchTable = allRackPatchTables.sliced(rackNum * (kLugCounts.at(Rack::Type::Enr96) * 2));
+        const auto rackPatchTable = allRackPatchTables.sliced(rackNum * (RackTraits<Rack::Type::Enr96>::kDescriptor.lugCount * 2));
         rack->fromByteArray(rackPatchTable);
     }
 
@@ -314,16 +242,18 @@ void EnrRom::loadFromData(QByteArrayView data)
 
 QByteArray EnrRom::toByteArray() const
 {
-    QByteArray data = software_;
+    QByteArray data = getSoftware();
+    data.resize(kPatchTableEnd);
     for (const auto *rack : racks_) {
         const auto *enrRack = dynamic_cast<const EnrRack *>(rack);
         Q_ASSERT_X(enrRack != nullptr,
                    std::source_location::current().function_name(),
                    "Non ENR Rack stored in ENR patch rom.");
-        const auto patchTableLength = kLugCounts.at(enrRack->getRackType()) * 2;
+        const auto patchTableLength = enrRack->getLugCount() * 2;
         const unsigned int dataOffset = kPatchTableStart + (enrRack->getRackNum() * patchTableLength);
         data.replace(dataOffset, patchTableLength, enrRack->toByteArray());
     }
+    data.append(trailer_);
 
     return data;
 }
@@ -357,6 +287,30 @@ QString EnrRom::getTitle() const
     return tr("ENR Rack v%1").arg(getVersionNames().value(version_));
 }
 
+const QByteArray &EnrRom::getSoftware() const
+{
+    if (version_ == Version::Unknown) {
+        return software_;
+    }
+    // The software and the trailer are stored separately so each is keyed by the hash of exactly its own bytes.
+    const auto path = kSoftwareFilepaths.value(version_);
+    auto &store = SoftwareImageStore::get();
+    if (software_.isEmpty()) {
+        software_ = store.internResource(path, software_hash_, 0, kPatchTableStart);
+        Q_ASSERT_X(!software_.isEmpty(),
+                   std::source_location::current().function_name(),
+                   "Failed to open software version from internal resource.");
+    }
+    if (trailer_.isEmpty()) {
+        trailer_ = store.internResource(path, kTrailerChecksum, kPatchTableEnd,
+                                        kRomSizes.at(Rack::Type::Enr96) - kPatchTableEnd);
+        Q_ASSERT_X(!trailer_.isEmpty(),
+                   std::source_location::current().function_name(),
+                   "Failed to open software version from internal resource.");
+    }
+    return software_;
+}
+
 QByteArray EnrRom::getSoftwareHash() const
 {
     return software_hash_;
@@ -364,17 +318,41 @@ QByteArray EnrRom::getSoftwareHash() const
 
 QByteArray EnrRom::getPatchHash() const
 {
-    return QCryptographicHash::hash(toByteArray().sliced(kPatchTableStart), getHashAlgorithm());
+    // Racks are stored back-to-back between the software and the trailer, so this matches hashing that part of
+    // toByteArray() without building the whole ROM.
+    QCryptographicHash hash(getHashAlgorithm());
+    for (const auto *rack : racks_) {
+        hash.addData(dynamic_cast<const EnrRack *>(rack)->toByteArray());
+    }
+    return hash.result();
 }
 
-bool EnrRack::is1To1(const Rack *rack)
+uint8_t EnrRom::getPatchTableVariant() const
 {
-    for (const auto lugAddress : rack->getLugAddressesView()) {
-        if (lugAddress.second != 511) {
-            return false;
-        }
+    return static_cast<uint8_t>(version_);
+}
+
+void EnrRom::setPatchTableVariant(uint8_t variant)
+{
+    const auto version = static_cast<Version>(variant);
+    if (kSoftwareFilepaths.contains(version)) {
+        setVersion(version);
     }
-    return true;
+    else {
+        // Software isn't stored with the patch table, so unrecognized software can't be restored.
+        version_ = Version::Unknown;
+        markChanged();
+        Q_EMIT(versionChanged(version_));
+        Q_EMIT(titleChanged());
+    }
+}
+
+bool EnrRack::is1To1(const Rack *rack)
+{
+    return std::ranges::all_of(rack->getLugsView(), [](const Rack::LugEntry &lugEntry)
+    {
+        return lugEntry.address == 511;
+    });
 }
 
 };
@@ -0,0 +1,41 @@
+/**
+ * @file PatchTable.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#include "patchlib/PatchTable.h"
+#include "patchlib/Exceptions.h"
+
+namespace patchman
+{
+
+PatchTableView::PatchTableView(QByteArrayView data)
+{
+    if (data.size() < kHeaderSize || static_cast<uint8_t>(data.at(0)) != kFormat) {
+        throw InvalidRomException(tr("Unsupported patch table."));
+    }
+    romType_ = static_cast<uint8_t>(data.at(1));
+    variant_ = static_cast<uint8_t>(data.at(2));
+
+    const unsigned int rackCount = static_cast<uint8_t>(data.at(3));
+    racks_.reserve(rackCount);
+    qsizetype pos = kHeaderSize;
+    for (unsigned int rackNum = 0; rackNum < rackCount; ++rackNum) {
+        if (pos + kRackHeaderSize > data.size()) {
+            throw InvalidRomException(tr("Patch table is truncated."));
+        }
+        const auto rackType = static_cast<Rack::Type>(static_cast<uint8_t>(data.at(pos)));
+        const auto rackSize = static_cast<qsizetype>(static_cast<uint8_t>(data.at(pos + 1)) * sizeof(uint16_t));
+        pos += kRackHeaderSize;
+        if (pos + rackSize > data.size()) {
+            throw InvalidRomException(tr("Patch table is truncated."));
+        }
+        racks_.push_back(RackView{rackType, data.sliced(pos, rackSize)});
+        pos += rackSize;
+    }
+}
+
+} // patchman
@@ -7,6 +7,10 @@
  */
 
 #include "patchlib/Rack.h"
+#include "patchlib/RackDescriptor.h"
+#include <algorithm>
+#include <atomic>
+#include <optional>
 #include <source_location>
 
 namespace patchman
@@ -16,7 +20,7 @@ bool operator==(const Rack &lhs, const Rack &rhs)
 {
     return lhs.rackNum_ == rhs.rackNum_ &&
         lhs.rackType_ == rhs.rackType_ &&
-        lhs.lugAddresses_ == rhs.lugAddresses_;
+        std::ranges::equal(lhs.getLugWords(), rhs.getLugWords());
 }
 
 std::strong_ordering operator<=>(const Rack &lhs, const Rack &rhs)
@@ -32,6 +36,7 @@ unsigned int Rack::getRackNum() const
 void Rack::setRackNum(unsigned int rackNum)
 {
     rackNum_ = rackNum;
+    markChanged();
     Q_EMIT(rackNumChanged());
 }
 
@@ -43,6 +48,7 @@ Rack::Type Rack::getRackType() const
 void Rack::setRackType(Rack::Type rackType)
 {
     rackType_ = rackType;
+    markChanged();
     Q_EMIT(rackTypeChanged());
 }
 
@@ -51,34 +57,152 @@ QString Rack::getRackName() const
     return tr("Rack %1").arg(getRackNum());
 }
 
+const RackDescriptor &Rack::getDescriptor() const
+{
+    return getRackDescriptor(rackType_);
+}
+
+unsigned int Rack::getLugsPerModule() const
+{
+    return getDescriptor().lugsPerModule;
+}
+
+unsigned int Rack::getModuleDensityForLug(unsigned int lug) const
+{
+    Q_ASSERT_X(lug < lugCount_,
+               std::source_location::current().function_name(),
+               "Tried to get lug not in rack.");
+    return getDescriptor().getModuleDensityForLug(getLugWords(), lug);
+}
+
 QString Rack::getModuleNameForLug(unsigned int lug) const
 {
-    const auto density = getModuleDensityForLug(lug);
-    return tr("%1 Ckt Module").arg(density);
+    return getDescriptor().getModuleName(getModuleDensityForLug(lug));
+}
+
+Phase Rack::getPhaseForLug(unsigned int lug) const
+{
+    return getDescriptor().getPhaseForLug(lug);
+}
+
+unsigned int Rack::getLugForCircuit(unsigned int circuit) const
+{
+    return getDescriptor().getLugForCircuit(circuit);
+}
+
+unsigned int Rack::getCircuitForLug(unsigned int lug) const
+{
+    return getDescriptor().getCircuitForLug(lug);
 }
 
 unsigned int Rack::getLugAddress(unsigned int lug) const
 {
-    Q_ASSERT_X(lug < lugAddresses_.size(),
+    Q_ASSERT_X(lug < lugCount_,
                std::source_location::current().function_name(),
                "Tried to get lug not in rack.");
-    return lugAddresses_.at(lug);
+    return lugWords_[lug] & kLugWordAddressMask;
 }
 
 void Rack::setLugAddress(unsigned int lug, unsigned int address)
 {
-    Q_ASSERT_X(lug < lugAddresses_.size(),
+    Q_ASSERT_X(lug < lugCount_,
+               std::source_location::current().function_name(),
+               "Tried to set lug not in rack.");
+    editLugWords(std::views::single(lug), [address](unsigned int, uint16_t word)
+    {
+        return (word & ~kLugWordAddressMask) | (address & kLugWordAddressMask);
+    });
+    Q_EMIT(lugChanged(lug));
+}
+
+void Rack::setLugAddresses(std::span<const LugEdit> edits)
+{
+    if (edits.empty()) {
+        return;
+    }
+    std::array<std::optional<unsigned int>, kMaxLugCount> newAddresses;
+    unsigned int firstLug = lugCount_;
+    unsigned int lastLug = 0;
+    for (const auto &edit : edits) {
+        Q_ASSERT_X(edit.lug < lugCount_,
+                   std::source_location::current().function_name(),
+                   "Tried to set lug not in rack.");
+        // Later edits to the same lug win.
+        newAddresses[edit.lug] = edit.address;
+        firstLug = std::min(firstLug, edit.lug);
+        lastLug = std::max(lastLug, edit.lug);
+    }
+    editLugWords(
+        std::views::iota(firstLug, lastLug + 1)
+            | std::views::filter([&newAddresses](unsigned int lug) { return newAddresses[lug].has_value(); }),
+        [&newAddresses](unsigned int lug, uint16_t word)
+        {
+            return (word & ~kLugWordAddressMask) | (*newAddresses[lug] & kLugWordAddressMask);
+        });
+    Q_EMIT(lugRangeChanged(firstLug, lastLug));
+}
+
+uint16_t Rack::getLugWord(unsigned int lug) const
+{
+    Q_ASSERT_X(lug < lugCount_,
+               std::source_location::current().function_name(),
+               "Tried to get lug not in rack.");
+    return lugWords_[lug];
+}
+
+void Rack::setLugWord(unsigned int lug, uint16_t word)
+{
+    Q_ASSERT_X(lug < lugCount_,
                std::source_location::current().function_name(),
                "Tried to set lug not in rack.");
-    lugAddresses_[lug] = address;
+    editLugWords(std::views::single(lug), [word](unsigned int, uint16_t)
+    {
+        return word;
+    });
     Q_EMIT(lugChanged(lug));
 }
 
+void Rack::applyLugDeltas(std::span<const LugDelta> deltas, bool reverse)
+{
+    if (deltas.empty()) {
+        return;
+    }
+    unsigned int firstLug = lugCount_;
+    unsigned int lastLug = 0;
+    for (const auto &delta : deltas) {
+        Q_ASSERT_X(delta.lug < lugCount_,
+                   std::source_location::current().function_name(),
+                   "Tried to set lug not in rack.");
+        lugWords_[delta.lug] = (reverse ? delta.before : delta.after) & lugWordMask_;
+        firstLug = std::min<unsigned int>(firstLug, delta.lug);
+        lastLug = std::max<unsigned int>(lastLug, delta.lug);
+    }
+    markChanged();
+    Q_EMIT(lugRangeChanged(firstLug, lastLug));
+}
+
 bool Rack::isPatched() const
 {
-    return std::any_of(lugAddresses_.cbegin(), lugAddresses_.cend(),
-                       [](unsigned int addr)
-                       { return addr > 0; });
+    return std::ranges::any_of(getLugWords(),
+                               [](uint16_t word)
+                               { return (word & kLugWordAddressMask) > 0; });
+}
+
+void Rack::initLugWords(unsigned int lugCount, uint16_t lugWordMask)
+{
+    Q_ASSERT_X(lugCount <= kMaxLugCount,
+               std::source_location::current().function_name(),
+               "Too many lugs for rack.");
+    lugCount_ = lugCount;
+    lugWordMask_ = lugWordMask;
+    lugWords_.fill(0);
+    markChanged();
+}
+
+quint64 Rack::nextEditVersion()
+{
+    static std::atomic<quint64> lastEditVersion = 0;
+    return ++lastEditVersion;
 }
 
 } // patchlib
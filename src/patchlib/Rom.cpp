@@ -11,9 +11,12 @@
 #include "patchlib/BinLoader.h"
 #include "patchlib/Enr.h"
 #include "patchlib/Exceptions.h"
+#include "patchlib/PatchTable.h"
 #include <frozen/map.h>
 #include <QtEndian>
 #include <QCryptographicHash>
+#include <algorithm>
+#include <memory>
 
 namespace patchman
 {
@@ -67,9 +70,21 @@ Rom *Rom::create(Rom::Type romType, QObject *parent)
     Q_UNREACHABLE();
 }
 
-Rom::Type Rom::guessType(const QString &path)
+Rom *Rom::createFromFile(const QString &path, QObject *parent)
 {
     const auto data = BinLoader::loadFile(path);
+    std::unique_ptr<Rom> rom(create(guessType(data), parent));
+    rom->loadFromData(data);
+    return rom.release();
+}
+
+Rom::Type Rom::guessType(const QString &path)
+{
+    return guessType(BinLoader::loadFile(path));
+}
+
+Rom::Type Rom::guessType(QByteArrayView data)
+{
     for (const auto &[romType, guesser]: kRomTypeGuessers) {
         if (guesser(data)) {
             return romType;
@@ -94,6 +109,60 @@ void Rom::saveToFile(const QString &path) const
     file.write(data);
 }
 
+QByteArray Rom::toPatchTable() const
+{
+    QByteArray data;
+    data.reserve(PatchTableView::kHeaderSize
+                     + racks_.size() * (PatchTableView::kRackHeaderSize + Rack::kMaxLugCount * sizeof(uint16_t)));
+    data.push_back(static_cast<char>(PatchTableView::kFormat));
+    data.push_back(static_cast<char>(getType()));
+    data.push_back(static_cast<char>(getPatchTableVariant()));
+    data.push_back(static_cast<char>(racks_.size()));
+    for (const auto *rack : racks_) {
+        // Rack header: type, lug count.
+        data.push_back(static_cast<char>(rack->getRackType()));
+        data.push_back(static_cast<char>(rack->getLugCount()));
+        const auto words = rack->getLugWords();
+        const auto pos = data.size();
+        data.resize(pos + static_cast<qsizetype>(words.size() * sizeof(uint16_t)));
+        qToLittleEndian<uint16_t>(words.data(), static_cast<qsizetype>(words.size()), data.data() + pos);
+    }
+
+    return data;
+}
+
+Rom *Rom::fromPatchTable(QByteArrayView data, QObject *parent)
+{
+    const PatchTableView patchTable(data);
+    const auto romType = static_cast<Type>(patchTable.getRomType());
+    const auto romTypes = allTypes();
+    if (std::ranges::find(romTypes, romType) == romTypes.end()) {
+        throw InvalidRomException(tr("Unsupported patch table."));
+    }
+    std::unique_ptr<Rom> rom(create(romType, parent));
+    rom->setPatchTableVariant(patchTable.getVariant());
+
+    const auto &rackTables = patchTable.getRacks();
+    for (unsigned int rackNum = 0; rackNum < rackTables.size(); ++rackNum) {
+        const auto &rackTable = rackTables.at(rackNum);
+        auto *rack = rom->getRack(rackNum);
+        if (rack == nullptr) {
+            rack = rom->addRack(rackNum, rackTable.rackType);
+        }
+        if (rack->getLugCount() != rackTable.getLugCount()) {
+            throw InvalidRomException(tr("Patch table does not match the ROM type."));
+        }
+        for (unsigned int lug = 0; lug < rackTable.getLugCount(); ++lug) {
+            rack->setLugWord(lug, rackTable.getLugWord(lug));
+        }
+    }
+    while (rom->racks_.size() > rackTables.size()) {
+        rom->removeRack(rom->racks_.size() - 1);
+    }
+
+    return rom.release();
+}
+
 void Rom::removeRack(unsigned int rackNum)
 {
     qsizetype removedCount = 0;
@@ -117,6 +186,7 @@ void Rom::removeRack(unsigned int rackNum)
     }
 
     if (removedCount > 0) {
+        markChanged();
         Q_EMIT(rackRemoved(rackNum));
         sortRacks();
     }
@@ -132,6 +202,24 @@ Rack *Rom::getRack(unsigned int rackNum) const
     }
 }
 
+quint64 Rom::getEditVersion() const
+{
+    auto editVersion = editVersion_;
+    for (const auto *rack : racks_) {
+        editVersion = std::max(editVersion, rack->getEditVersion());
+    }
+    return editVersion;
+}
+
+RomSnapshot Rom::getSnapshot() const
+{
+    const auto editVersion = getEditVersion();
+    if (snapshot_.isNull() || snapshot_.getEditVersion() != editVersion) {
+        snapshot_ = RomSnapshot(editVersion, toPatchTable());
+    }
+    return snapshot_;
+}
+
 void Rom::sortRacks()
 {
     std::sort(racks_.begin(), racks_.end(), [](const Rack *lhs, const Rack *rhs)
@@ -0,0 +1,89 @@
+/**
+ * @file RomDiff.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#include "patchlib/RomDiff.h"
+#include <algorithm>
+
+namespace patchman
+{
+
+RomDiff RomDiff::compare(const PatchTableView &source, const PatchTableView &modified)
+{
+    // Lugs compared at once when looking for differences.
+    static constexpr unsigned int kLugsPerChunk = sizeof(quint64) / sizeof(uint16_t);
+
+    RomDiff diff;
+    diff.sourceRomType_ = source.getRomType();
+    diff.modifiedRomType_ = modified.getRomType();
+
+    const auto &sourceRacks = source.getRacks();
+    const auto &modifiedRacks = modified.getRacks();
+    const auto rackCount = std::max(sourceRacks.size(), modifiedRacks.size());
+    for (qsizetype rackNum = 0; rackNum < rackCount; ++rackNum) {
+        const auto sourceWords = rackNum < sourceRacks.size() ? sourceRacks.at(rackNum).words : QByteArrayView();
+        const auto modifiedWords = rackNum < modifiedRacks.size() ? modifiedRacks.at(rackNum).words : QByteArrayView();
+        const auto wordAt = [](QByteArrayView words, unsigned int lug) -> uint16_t
+        {
+            if (lug * sizeof(uint16_t) >= static_cast<size_t>(words.size())) {
+                return 0;
+            }
+            return qFromLittleEndian<uint16_t>(words.data() + lug * sizeof(uint16_t));
+        };
+        const auto compareLugs = [&](unsigned int firstLug, unsigned int lastLug)
+        {
+            for (unsigned int lug = firstLug; lug < lastLug; ++lug) {
+                const auto sourceWord = wordAt(sourceWords, lug);
+                const auto modifiedWord = wordAt(modifiedWords, lug);
+                if (sourceWord != modifiedWord) {
+                    diff.lugDiffs_.push_back(LugDiff{
+                        .rack = static_cast<unsigned int>(rackNum),
+                        .lug = lug,
+                        .circuit = lug,
+                        .sourceWord = sourceWord,
+                        .modifiedWord = modifiedWord,
+                    });
+                }
+            }
+        };
+
+        const auto commonLugCount =
+            static_cast<unsigned int>(std::min(sourceWords.size(), modifiedWords.size()) / sizeof(uint16_t));
+        unsigned int lug = 0;
+        for (; lug + kLugsPerChunk <= commonLugCount; lug += kLugsPerChunk) {
+            const auto offset = lug * sizeof(uint16_t);
+            if (qFromUnaligned<quint64>(sourceWords.data() + offset)
+                != qFromUnaligned<quint64>(modifiedWords.data() + offset)) {
+                compareLugs(lug, lug + kLugsPerChunk);
+            }
+        }
+        const auto lugCount =
+            static_cast<unsigned int>(std::max(sourceWords.size(), modifiedWords.size()) / sizeof(uint16_t));
+        compareLugs(lug, lugCount);
+    }
+
+    return diff;
+}
+
+RomDiff RomDiff::compare(const Rom &source, const Rom &modified)
+{
+    const auto sourcePatchTable = source.toPatchTable();
+    const auto modifiedPatchTable = modified.toPatchTable();
+    auto diff = compare(PatchTableView(sourcePatchTable), PatchTableView(modifiedPatchTable));
+    for (auto &lugDiff : diff.lugDiffs_) {
+        const auto *rack = source.getRack(lugDiff.rack);
+        if (rack == nullptr || rack->getLugCount() <= lugDiff.lug) {
+            rack = modified.getRack(lugDiff.rack);
+        }
+        if (rack != nullptr && lugDiff.lug < rack->getLugCount()) {
+            lugDiff.circuit = rack->getCircuitForLug(lugDiff.lug);
+        }
+    }
+    return diff;
+}
+
+} // patchman
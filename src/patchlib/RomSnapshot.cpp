@@ -0,0 +1,27 @@
+/**
+ * @file RomSnapshot.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#include "patchlib/RomSnapshot.h"
+#include "patchlib/Rom.h"
+
+namespace patchman
+{
+
+PatchTableView RomSnapshot::getPatchTableView() const
+{
+    Q_ASSERT(!isNull());
+    return PatchTableView(d_->patchTable);
+}
+
+Rom *RomSnapshot::toRom(QObject *parent) const
+{
+    Q_ASSERT(!isNull());
+    return Rom::fromPatchTable(d_->patchTable, parent);
+}
+
+} // patchman
@@ -0,0 +1,73 @@
+/**
+ * @file SoftwareImageStore.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#include "patchlib/SoftwareImageStore.h"
+#include <QResource>
+
+namespace patchman
+{
+
+SoftwareImageStore &SoftwareImageStore::get()
+{
+    static SoftwareImageStore instance;
+    return instance;
+}
+
+QByteArray SoftwareImageStore::intern(QByteArrayView data, const QByteArray &hash)
+{
+    std::scoped_lock imagesGuard(mutex_);
+    auto it = images_.find(hash);
+    if (it == images_.end()) {
+        it = images_.insert(hash, data.toByteArray());
+    }
+    return *it;
+}
+
+QByteArray SoftwareImageStore::internResource(const QString &path, const QByteArray &hash, qsizetype pos,
+                                              qsizetype size)
+{
+    std::scoped_lock imagesGuard(mutex_);
+    auto it = images_.find(hash);
+    if (it == images_.end()) {
+        const QResource resource(path);
+        if (!resource.isValid()) {
+            return {};
+        }
+        QByteArray image;
+        if (resource.compressionAlgorithm() == QResource::NoCompression) {
+            if (resource.size() < pos + size) {
+                return {};
+            }
+            // Resource data lives as long as the program does.
+            image = QByteArray::fromRawData(reinterpret_cast<const char *>(resource.data()) + pos, size);
+        }
+        else {
+            const auto data = resource.uncompressedData();
+            if (data.size() < pos + size) {
+                return {};
+            }
+            image = data.sliced(pos, size);
+        }
+        it = images_.insert(hash, image);
+    }
+    return *it;
+}
+
+QByteArray SoftwareImageStore::find(const QByteArray &hash) const
+{
+    std::scoped_lock imagesGuard(mutex_);
+    return images_.value(hash);
+}
+
+qsizetype SoftwareImageStore::size() const
+{
+    std::scoped_lock imagesGuard(mutex_);
+    return images_.size();
+}
+
+} // patchman
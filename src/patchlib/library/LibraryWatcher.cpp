@@ -0,0 +1,224 @@
+/**
+ * @file LibraryWatcher.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#include "patchlib/library/LibraryWatcher.h"
+#include <QtConcurrent>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <algorithm>
+
+namespace patchman
+{
+
+LibraryWatcher::LibraryWatcher(QObject *parent)
+    : QObject(parent),
+      fsWatcher_(new QFileSystemWatcher(this)),
+      pollTimer_(new QTimer(this)),
+      pollWatcher_(new PollWatcher(this)),
+      changedTimer_(new QTimer(this))
+{
+    connect(fsWatcher_, &QFileSystemWatcher::directoryChanged, this, &LibraryWatcher::directoryChanged);
+
+    pollTimer_->setInterval(kMinPollInterval);
+    connect(pollTimer_, &QTimer::timeout, this, &LibraryWatcher::poll);
+    connect(pollWatcher_, &PollWatcher::finished, this, &LibraryWatcher::pollFinished);
+
+    // Copying a directory of ROMs generates many events; only report the end of the burst.
+    changedTimer_->setSingleShot(true);
+    changedTimer_->setInterval(kChangedDelay);
+    connect(changedTimer_, &QTimer::timeout, this, &LibraryWatcher::changed);
+}
+
+void LibraryWatcher::setRootPaths(const QStringList &rootPaths)
+{
+    for (auto *walkWatcher : walks_) {
+        walkWatcher->cancel();
+        walkWatcher->deleteLater();
+    }
+    walks_.clear();
+    const auto watched = fsWatcher_->directories();
+    if (!watched.empty()) {
+        fsWatcher_->removePaths(watched);
+    }
+    known_.clear();
+    polled_.clear();
+    pollTimer_->stop();
+
+    rootPaths_.clear();
+    for (const auto &rootPath : rootPaths) {
+        rootPaths_.push_back(QDir::cleanPath(rootPath));
+    }
+    for (const auto &rootPath : rootPaths_) {
+        walk(rootPath);
+    }
+}
+
+void LibraryWatcher::walk(const QString &path)
+{
+    static const qsizetype kBatchSize = 256;
+    auto *walkWatcher = new DirWalkWatcher(this);
+    connect(walkWatcher, &DirWalkWatcher::resultReadyAt, this, [this, walkWatcher](int ix)
+    {
+        watch(walkWatcher->resultAt(ix));
+    });
+    connect(walkWatcher, &DirWalkWatcher::finished, this, [this, walkWatcher]()
+    {
+        walks_.removeOne(walkWatcher);
+        walkWatcher->deleteLater();
+    });
+    walks_.push_back(walkWatcher);
+    walkWatcher->setFuture(QtConcurrent::run([path](QPromise<QStringList> &promise)
+    {
+        if (!QFileInfo(path).isDir()) {
+            return;
+        }
+        QStringList batch{path};
+        for (QDirIterator it(path, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories); it.hasNext();) {
+            if (promise.isCanceled()) {
+                return;
+            }
+            batch.push_back(it.next());
+            if (batch.size() >= kBatchSize) {
+                promise.addResult(batch);
+                batch.clear();
+            }
+        }
+        if (!batch.empty()) {
+            promise.addResult(batch);
+        }
+    }));
+}
+
+void LibraryWatcher::watch(const QStringList &dirs)
+{
+    QStringList newDirs;
+    newDirs.reserve(dirs.size());
+    for (const auto &dir : dirs) {
+        if (!known_.contains(dir) && isUnderRoot(dir)) {
+            known_.insert(dir);
+            newDirs.push_back(dir);
+        }
+    }
+    if (newDirs.empty()) {
+        return;
+    }
+
+    const auto unwatched = fsWatcher_->addPaths(newDirs);
+    if (unwatched.empty()) {
+        return;
+    }
+    if (polled_.empty()) {
+        qWarning() << "Unable to watch all ROM directories; falling back to polling for" << unwatched.size()
+                   << "directories.";
+    }
+    for (const auto &dir : unwatched) {
+        polled_.insert(dir, QFileInfo(dir).lastModified().toMSecsSinceEpoch());
+    }
+    if (!pollTimer_->isActive()) {
+        pollTimer_->start(kMinPollInterval);
+    }
+}
+
+void LibraryWatcher::unwatchTree(const QString &path)
+{
+    const auto prefix = path + '/';
+    QStringList removed;
+    for (auto it = known_.begin(); it != known_.end();) {
+        if (*it == path || it->startsWith(prefix)) {
+            removed.push_back(*it);
+            polled_.remove(*it);
+            it = known_.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    if (!removed.empty()) {
+        fsWatcher_->removePaths(removed);
+    }
+    if (polled_.empty()) {
+        pollTimer_->stop();
+    }
+}
+
+bool LibraryWatcher::isUnderRoot(const QString &path) const
+{
+    return std::any_of(rootPaths_.cbegin(), rootPaths_.cend(), [&path](const QString &rootPath)
+    {
+        return path == rootPath || path.startsWith(rootPath + '/');
+    });
+}
+
+void LibraryWatcher::directoryChanged(const QString &path)
+{
+    changedTimer_->start();
+    if (!QFileInfo(path).isDir()) {
+        unwatchTree(path);
+        return;
+    }
+
+    // Only this directory's children can be new; deeper changes generate their own events.
+    for (QDirIterator it(path, QDir::Dirs | QDir::NoDotAndDotDot); it.hasNext();) {
+        const auto child = it.next();
+        if (!known_.contains(child)) {
+            walk(child);
+        }
+    }
+}
+
+void LibraryWatcher::poll()
+{
+    if (pollWatcher_->isRunning()) {
+        return;
+    }
+    pollWatcher_->setFuture(QtConcurrent::run(&LibraryWatcher::statDirs, polled_.keys()));
+}
+
+void LibraryWatcher::pollFinished()
+{
+    if (pollWatcher_->isCanceled() || pollWatcher_->future().resultCount() == 0) {
+        return;
+    }
+    const auto mtimes = pollWatcher_->result();
+    QStringList changedDirs;
+    for (auto it = mtimes.cbegin(); it != mtimes.cend(); ++it) {
+        const auto polledIt = polled_.find(it.key());
+        if (polledIt == polled_.end()) {
+            // Stopped polling while the stat was running.
+            continue;
+        }
+        if (*polledIt != it.value()) {
+            *polledIt = it.value();
+            changedDirs.push_back(it.key());
+        }
+    }
+
+    if (changedDirs.empty()) {
+        // Back off while nothing is happening.
+        pollTimer_->setInterval(std::min(pollTimer_->interval() * 2, kMaxPollInterval));
+    }
+    else {
+        pollTimer_->setInterval(kMinPollInterval);
+        for (const auto &dir : changedDirs) {
+            directoryChanged(dir);
+        }
+    }
+}
+
+QHash<QString, qint64> LibraryWatcher::statDirs(const QStringList &paths)
+{
+    QHash<QString, qint64> mtimes;
+    mtimes.reserve(paths.size());
+    for (const auto &path : paths) {
+        const QFileInfo fileInfo(path);
+        mtimes.insert(path, fileInfo.isDir() ? fileInfo.lastModified().toMSecsSinceEpoch() : -1);
+    }
+    return mtimes;
+}
+
+} // patchman
@@ -12,30 +12,149 @@
 namespace patchman
 {
 
+/**
+ * Column positions in getSelectSql().
+ */
+enum class SelectColumn
+{
+    Id,
+    DirPath,
+    FileName,
+    FileMTime,
+    HashAlgo,
+    SoftwareHash,
+    PatchHash,
+    RomType,
+    RackCount,
+    RomChecksum,
+    Signature,
+};
+
+/**
+ * Collation for stored directory paths and file names. Windows and macOS file systems ignore case by default, so
+ * names that differ only in case refer to the same file there.
+ */
+#if defined(Q_OS_WIN) || defined(Q_OS_MACOS)
+static const auto kPathCollation = "collate NOCASE";
+#else
+static const auto kPathCollation = "";
+#endif
+
 QList<QSqlQuery> RomInfo::getDDL()
 {
     return {
         QSqlQuery(QString(R"(
-create table if not exists rom_info
+create table if not exists %1
 (
-    %1  text primary key not null collate NOCASE,
-    %2  text,
-    %3  integer,
-    %4  BLOB,
-    %5  BLOB,
+    id  integer primary key,
+    %2  text not null unique %3
+);
+)")
+                      .arg(kDirTable)
+                      .arg(kColDirPath)
+                      .arg(kPathCollation)),
+        QSqlQuery(QString(R"(
+create table if not exists %1
+(
+    %2  integer primary key,
+    %3  integer not null references %4 (id) on delete cascade,
+    %5  text not null %14,
     %6  integer,
     %7  integer,
-    %8  BLOB
+    %8  BLOB,
+    %9  BLOB,
+    %10 integer,
+    %11 integer,
+    %12 BLOB,
+    %13 BLOB,
+    unique (%3, %5)
 );
 )")
-                      .arg(kColFilePath)
+                      .arg(kTable)
+                      .arg(kColId)
+                      .arg(kColDirId)
+                      .arg(kDirTable)
+                      .arg(kColFileName)
                       .arg(kColFileMTime)
                       .arg(kColHashAlgo)
                       .arg(kColSoftwareHash)
                       .arg(kColPatchHash)
                       .arg(kColRomType)
                       .arg(kColRackCount)
-                      .arg(kColRomChecksum)),
+                      .arg(kColRomChecksum)
+                      .arg(kColSignature)
+                      .arg(kPathCollation)),
+        QSqlQuery(QString(R"(
+create table if not exists %1
+(
+    %2  integer primary key references %3 (%4) on delete cascade,
+    %5  BLOB not null
+);
+)")
+                      .arg(kPatchTable)
+                      .arg(kColRomId)
+                      .arg(kTable)
+                      .arg(kColId)
+                      .arg(kColPatchTable)),
+        QSqlQuery(QString(R"(
+create table if not exists %1
+(
+    %2  integer not null,
+    %3  integer not null,
+    %4  integer not null references %5 (%6) on delete cascade,
+    %7  integer not null,
+    %8  integer not null,
+    primary key (%2, %3, %4, %7)
+) without rowid;
+)")
+                      .arg(kPatchIndexTable)
+                      .arg(kColAddress)
+                      .arg(kColRack)
+                      .arg(kColRomId)
+                      .arg(kTable)
+                      .arg(kColId)
+                      .arg(kColLug)
+                      .arg(kColCircuit)),
+        QSqlQuery(QString(R"(
+create index if not exists patch_index_rom_id_index
+    on %1 (%2);
+)").arg(kPatchIndexTable, kColRomId)),
+        QSqlQuery(QString(R"(
+create table if not exists %1
+(
+    %2  integer not null,
+    %3  integer not null references %4 (%5) on delete cascade,
+    primary key (%2, %3)
+) without rowid;
+)")
+                      .arg(kLshTable)
+                      .arg(kColBandHash)
+                      .arg(kColRomId)
+                      .arg(kTable)
+                      .arg(kColId)),
+        QSqlQuery(QString(R"(
+create index if not exists rom_lsh_rom_id_index
+    on %1 (%2);
+)").arg(kLshTable, kColRomId)),
+        QSqlQuery(QString(R"(
+create table if not exists %1
+(
+    %2  integer not null references %4 (%5) on delete cascade,
+    %3  integer not null references %4 (%5) on delete cascade,
+    %6  real not null,
+    primary key (%2, %3)
+) without rowid;
+)")
+                      .arg(kSimilarityTable)
+                      .arg(kColRomA)
+                      .arg(kColRomB)
+                      .arg(kTable)
+                      .arg(kColId)
+                      .arg(kColSimilarity)),
+        QSqlQuery(QString(R"(
+create index if not exists rom_similarity_rom_b_index
+    on %1 (%2);
+)").arg(kSimilarityTable, kColRomB)),
         QSqlQuery(QString(R"(
 create index if not exists rom_info_patch_hash_index
     on rom_info (%1);
@@ -43,32 +162,72 @@ create index if not exists rom_info_patch_hash_index
     };
 }
 
-void RomInfo::bind(QSqlQuery &q, int pos)
+QString RomInfo::getSelectSql()
+{
+    static const auto sql = []()
+    {
+        QStringList columns{
+            QString("%1.%2").arg(kTable, kColId),
+            QString("%1.%2").arg(kDirTable, kColDirPath),
+            QString("%1.%2").arg(kTable, kColFileName),
+        };
+        for (const auto &column : kDataColumns) {
+            columns.push_back(QString("%1.%2").arg(kTable, column));
+        }
+        return QString("SELECT %1 FROM %2 JOIN %3 ON %3.id = %2.%4")
+            .arg(columns.join(", "), kTable, kDirTable, kColDirId);
+    }();
+    return sql;
+}
+
+void RomInfo::bind(QSqlQuery &q, int pos) const
 {
-    q.bindValue(pos++, filePath_);
-    q.bindValue(pos++, fileMTime_);
+    q.bindValue(pos++, fileMTimeNs_);
     q.bindValue(pos++, hashAlgo_);
     q.bindValue(pos++, softwareHash_);
     q.bindValue(pos++, patchHash_);
     q.bindValue(pos++, romType_);
     q.bindValue(pos++, rackCount_);
     q.bindValue(pos++, romChecksum_);
+    q.bindValue(pos++, signature_);
 }
 
-RomInfo RomInfo::hydrate(QSqlQuery &q)
+RomInfo RomInfo::hydrate(const QSqlQuery &q)
 {
     Q_ASSERT(q.isActive());
+    // Columns are read by position; looking them up by name is a string comparison for every column of every row.
+    const auto value = [&q](SelectColumn column)
+    {
+        return q.value(static_cast<int>(column));
+    };
     RomInfo o;
-    o.filePath_ = q.value(kColFilePath).toString();
-    o.fileMTime_ = q.value(kColFileMTime).toDateTime();
-    o.hashAlgo_ = q.value(kColHashAlgo).toInt();
-    o.softwareHash_ = q.value(kColSoftwareHash).toByteArray();
-    o.patchHash_ = q.value(kColPatchHash).toByteArray();
-    o.romType_ = q.value(kColRomType).toInt();
-    o.rackCount_ = q.value(kColRackCount).toUInt();
-    o.romChecksum_ = q.value(kColRomChecksum).toByteArray();
+    o.id_ = value(SelectColumn::Id).toLongLong();
+    const auto dirPath = value(SelectColumn::DirPath).toString();
+    const auto fileName = value(SelectColumn::FileName).toString();
+    if (dirPath.endsWith('/')) {
+        o.filePath_ = dirPath + fileName;
+    }
+    else {
+        o.filePath_ = dirPath + '/' + fileName;
+    }
+    o.fileMTimeNs_ = value(SelectColumn::FileMTime).toLongLong();
+    o.hashAlgo_ = value(SelectColumn::HashAlgo).toInt();
+    o.softwareHash_ = value(SelectColumn::SoftwareHash).toByteArray();
+    o.patchHash_ = value(SelectColumn::PatchHash).toByteArray();
+    o.romType_ = value(SelectColumn::RomType).toInt();
+    o.rackCount_ = value(SelectColumn::RackCount).toUInt();
+    o.romChecksum_ = value(SelectColumn::RomChecksum).toByteArray();
+    o.signature_ = value(SelectColumn::Signature).toByteArray();
 
     return o;
 }
 
+QString RomInfo::normalizePath(const QString &path)
+{
+    // Some filesystems (e.g. HFS+) decompose characters in file names, so the same name can arrive in either form.
+    // Case is left alone so names display as they are on disk; the path columns' collation handles case-insensitive
+    // filesystems.
+    return path.normalized(QString::NormalizationForm_C);
+}
+
 } // patchman
@@ -7,18 +7,39 @@
  */
 
 #include "patchlib/library/RomLibrary.h"
+#include "patchlib/library/RomSimilarity.h"
 #include "patchlib/Rom.h"
 #include "patchlib/Exceptions.h"
+#include "patchlib/PatchTable.h"
+#include <algorithm>
 #include <filesystem>
+#include <future>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <utility>
 #include <QtConcurrent>
 #include <QStandardPaths>
 #include <QSqlError>
+#include <QSqlRecord>
 
 QDirIterator getRomDirIterator(const QString &path)
 {
     return QDirIterator(path, QDir::Readable | QDir::Files | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
 }
 
+/**
+ * Queue @p function on @p pool ahead of any queued jobs with a lower priority.
+ */
+template<typename Function>
+auto scheduleJob(QThreadPool *pool, patchman::RomLibrary::Priority priority, Function &&function)
+{
+    return QtConcurrent::task(std::forward<Function>(function))
+        .onThreadPool(*pool)
+        .withPriority(static_cast<int>(priority))
+        .spawn();
+}
+
 namespace patchman
 {
 
@@ -28,6 +49,10 @@ RomLibrary::RomLibrary(QObject *parent)
     // Ensure that database work always happens on the same thread, without having to manually manage that thread.
     pool_.setMaxThreadCount(1);
     pool_.setExpiryTimeout(-1);
+    // Read connections belong to their threads, so keep those threads alive as well.
+    readPool_.setMaxThreadCount(kReadConnectionCount);
+    readPool_.setExpiryTimeout(-1);
+    similarityPool_.setMaxThreadCount(1);
 }
 
 RomLibrary *RomLibrary::get()
@@ -45,7 +70,7 @@ RomLibrary *RomLibrary::get()
 
 QFuture<void> RomLibrary::open()
 {
-    return QtConcurrent::run(&pool_, []()
+    return scheduleJob(&pool_, Priority::Interactive, []()
     {
 
         const auto dbPath = getDbPath();
@@ -117,6 +142,11 @@ QFuture<void> RomLibrary::open()
             QSqlQuery(QString("PRAGMA user_version = %1").arg(kAppVersion)),
             QSqlQuery("PRAGMA foreign_keys = 1;")
         };
+        if (dbPath != ":memory:") {
+            // WAL lets the read connections see the last commit while a scan is writing.
+            ddl.append(QSqlQuery("PRAGMA journal_mode = WAL;"));
+            ddl.append(QSqlQuery("PRAGMA synchronous = NORMAL;"));
+        }
         ddl.append(std::move(RomInfo::getDDL()));
 
         for (auto &q : ddl) {
@@ -127,7 +157,7 @@ QFuture<void> RomLibrary::open()
 
 QFuture<void> RomLibrary::cleanup()
 {
-    return QtConcurrent::run(&pool_, []()
+    return scheduleJob(&pool_, Priority::Maintenance, []()
     {
         if (!QSqlDatabase::database().isOpen()) {
             return;
@@ -145,14 +175,32 @@ QFuture<void> RomLibrary::cleanup()
 
 QFuture<QList<RomInfo>> RomLibrary::getAllRoms(const QStringList &searchPaths)
 {
-    return QtConcurrent::run(&pool_, [searchPaths](QPromise<QList<RomInfo>> &promise)
+    std::scoped_lock lastScanGuard(lastScanMutex_);
+    if (lastScan_.has_value() && !lastScan_->future.isFinished()) {
+        if (!lastScan_->started->load() && lastScan_->searchPaths == searchPaths) {
+            // The queued scan hasn't looked at the filesystem yet, so its result will be just as fresh.
+            return lastScan_->future;
+        }
+        lastScan_->future.cancel();
+    }
+
+    auto started = std::make_shared<std::atomic_bool>(false);
+    auto future = scheduleJob(&pool_, Priority::Scan, [searchPaths, started](QPromise<QList<RomInfo>> &promise)
     {
-        // Iterate through search dirs for ROMs.
+        started->store(true);
+        if (promise.isCanceled()) {
+            return;
+        }
+
+        // Count files before iterating for progress purposes.
         promise.setProgressRange(0, 0);
         promise.setProgressValue(0);
         int fileCount = 0;
         for (const auto &searchPath : searchPaths) {
             for (auto it = getRomDirIterator(searchPath); it.hasNext();) {
+                if (promise.isCanceled()) {
+                    return;
+                }
                 const auto fileInfo = it.nextFileInfo();
                 if (fileInfo.isFile()) {
                     ++fileCount;
@@ -161,27 +209,126 @@ QFuture<QList<RomInfo>> RomLibrary::getAllRoms(const QStringList &searchPaths)
         }
         promise.setProgressRange(0, fileCount);
 
-        // Count files before iterating for progress purposes.
-        // Track file paths on disk so we can prune non-existent files from the database.
-        QList<QVariant> foundOnDisk;
+        // Iterate through search dirs for ROMs.
+        // Track ROMs on disk so we can prune non-existent files from the database.
+        QSet<qint64> foundOnDisk;
         int progressValue = 0;
-        QSqlQuery filePathQ;
-        filePathQ.prepare(
-            QString("SELECT %1 FROM %2 WHERE %3 = ? LIMIT 1;")
-                .arg(RomInfo::kAllColumns.join(", "))
-                .arg(RomInfo::kTable)
-                .arg(RomInfo::kColFilePath)
+        // Directory ids are looked up once per directory, not once per file.
+        QHash<QString, qint64> dirIds;
+        QSqlQuery dirIdQ;
+        dirIdQ.prepare(
+            QString("SELECT id FROM %1 WHERE %2 = ?;")
+                .arg(RomInfo::kDirTable, RomInfo::kColDirPath)
         );
-        QSqlQuery saveRomInfoQ;
-        saveRomInfoQ.prepare(
-            QString("INSERT INTO %1(%2) VALUES(%3);")
-                .arg(RomInfo::kTable)
-                .arg(RomInfo::kAllColumns.join(", "))
-                .arg(QStringList(RomInfo::kAllColumns.size(), "?").join(", "))
+        QSqlQuery saveDirQ;
+        saveDirQ.prepare(
+            QString("INSERT INTO %1(%2) VALUES(?);")
+                .arg(RomInfo::kDirTable, RomInfo::kColDirPath)
         );
+        const auto getDirId = [&dirIds, &dirIdQ, &saveDirQ](const QString &dirPath) -> qint64
+        {
+            const auto cached = dirIds.constFind(dirPath);
+            if (cached != dirIds.cend()) {
+                return *cached;
+            }
+            qint64 dirId;
+            dirIdQ.bindValue(0, dirPath);
+            dirIdQ.exec();
+            if (dirIdQ.next()) {
+                dirId = dirIdQ.value(0).toLongLong();
+            }
+            else {
+                saveDirQ.bindValue(0, dirPath);
+                saveDirQ.exec();
+                dirId = saveDirQ.lastInsertId().toLongLong();
+            }
+            dirIdQ.finish();
+            dirIds.insert(dirPath, dirId);
+            return dirId;
+        };
+        QSqlQuery fileQ;
+        fileQ.prepare(
+            QString("SELECT %1, %2 FROM %3 WHERE %4 = ? AND %5 = ? LIMIT 1;")
+                .arg(RomInfo::kColId, RomInfo::kColFileMTime, RomInfo::kTable, RomInfo::kColDirId,
+                     RomInfo::kColFileName)
+        );
+        QSqlQuery insertRomInfoQ;
+        insertRomInfoQ.prepare(
+            QString("INSERT INTO %1(%2, %3, %4) VALUES(?, ?, %5);")
+                .arg(RomInfo::kTable, RomInfo::kColDirId, RomInfo::kColFileName)
+                .arg(RomInfo::kDataColumns.join(", "))
+                .arg(QStringList(RomInfo::kDataColumns.size(), "?").join(", "))
+        );
+        QSqlQuery updateRomInfoQ;
+        updateRomInfoQ.prepare(
+            QString("UPDATE %1 SET %2 = ? WHERE %3 = ?;")
+                .arg(RomInfo::kTable, RomInfo::kDataColumns.join(" = ?, "), RomInfo::kColId)
+        );
+        QSqlQuery clearIndexQ;
+        clearIndexQ.prepare(
+            QString("DELETE FROM %1 WHERE %2 = ?;").arg(RomInfo::kPatchIndexTable, RomInfo::kColRomId)
+        );
+        QSqlQuery insertIndexQ;
+        insertIndexQ.prepare(
+            QString("INSERT INTO %1(%2, %3, %4, %5, %6) VALUES(?, ?, ?, ?, ?);")
+                .arg(RomInfo::kPatchIndexTable, RomInfo::kColAddress, RomInfo::kColRack, RomInfo::kColRomId,
+                     RomInfo::kColLug, RomInfo::kColCircuit)
+        );
+        const auto indexPatch = [&clearIndexQ, &insertIndexQ](qint64 romId, const Rom &rom)
+        {
+            clearIndexQ.bindValue(0, romId);
+            clearIndexQ.exec();
+            for (const auto *rack : rom.getRacksView()) {
+                for (const auto [lug, address] : rack->getLugAddressesView()) {
+                    if (address == 0) {
+                        continue;
+                    }
+                    insertIndexQ.bindValue(0, address);
+                    insertIndexQ.bindValue(1, rack->getRackNum());
+                    insertIndexQ.bindValue(2, romId);
+                    insertIndexQ.bindValue(3, lug);
+                    insertIndexQ.bindValue(4, rack->getCircuitForLug(lug));
+                    insertIndexQ.exec();
+                }
+            }
+        };
+        QSqlQuery savePatchTableQ;
+        savePatchTableQ.prepare(
+            QString("INSERT OR REPLACE INTO %1(%2, %3) VALUES(?, ?);")
+                .arg(RomInfo::kPatchTable, RomInfo::kColRomId, RomInfo::kColPatchTable)
+        );
+        QSqlQuery clearSimilarityQ;
+        clearSimilarityQ.prepare(
+            QString("DELETE FROM %1 WHERE %2 = ?1 OR %3 = ?1;")
+                .arg(RomInfo::kSimilarityTable, RomInfo::kColRomA, RomInfo::kColRomB)
+        );
+        QSqlQuery clearBandsQ;
+        clearBandsQ.prepare(
+            QString("DELETE FROM %1 WHERE %2 = ?;").arg(RomInfo::kLshTable, RomInfo::kColRomId)
+        );
+        QSqlQuery insertBandQ;
+        insertBandQ.prepare(
+            QString("INSERT OR IGNORE INTO %1(%2, %3) VALUES(?, ?);")
+                .arg(RomInfo::kLshTable, RomInfo::kColBandHash, RomInfo::kColRomId)
+        );
+        const auto indexBands = [&clearBandsQ, &insertBandQ](qint64 romId, const QByteArray &signature)
+        {
+            clearBandsQ.bindValue(0, romId);
+            clearBandsQ.exec();
+            for (const auto bandHash : RomSimilarity::bandHashes(signature)) {
+                insertBandQ.bindValue(0, bandHash);
+                insertBandQ.bindValue(1, romId);
+                insertBandQ.exec();
+            }
+        };
+
+        // A single transaction avoids a journal sync for every changed file.
+        auto db = QSqlDatabase::database();
+        db.transaction();
         for (const auto &searchPath : searchPaths) {
             for (auto it = getRomDirIterator(searchPath); it.hasNext();) {
                 if (promise.isCanceled()) {
+                    db.commit();
                     return;
                 }
 
@@ -191,42 +338,59 @@ QFuture<QList<RomInfo>> RomLibrary::getAllRoms(const QStringList &searchPaths)
                 }
                 promise.setProgressValue(progressValue++);
                 const auto filePath = fileInfo.canonicalFilePath();
-                const auto fileMTime = fileInfo.lastModified().toUTC();
+                if (filePath.isEmpty()) {
+                    // Broken symlink.
+                    continue;
+                }
+                const QFileInfo canonicalFileInfo(filePath);
+                const auto dirId = getDirId(RomInfo::normalizePath(canonicalFileInfo.absolutePath()));
+                const auto fileName = RomInfo::normalizePath(canonicalFileInfo.fileName());
+                RomInfo romInfo;
+                romInfo.setFileMTime(fileInfo.lastModified());
 
                 // Has this file been modified?
-                auto romInfo = [&filePathQ, &filePath]() -> std::optional<RomInfo>
-                {
-                    filePathQ.bindValue(0, filePath);
-                    filePathQ.exec();
-                    if (filePathQ.size() <= 0) {
-                        return {};
+                std::optional<qint64> romId;
+                fileQ.bindValue(0, dirId);
+                fileQ.bindValue(1, fileName);
+                fileQ.exec();
+                if (fileQ.next()) {
+                    romId = fileQ.value(0).toLongLong();
+                    if (fileQ.value(1).toLongLong() == romInfo.getFileMTimeNs()) {
+                        // File is already in database and has not changed.
+                        foundOnDisk.insert(*romId);
+                        fileQ.finish();
+                        continue;
                     }
-                    filePathQ.next();
-                    return RomInfo::hydrate(filePathQ);
-                }();
-                if (romInfo.has_value() && romInfo->getFileMTime().toUTC() == fileMTime) {
-                    // File is already in database and has not changed.
-                    foundOnDisk.push_back(filePath);
-                    continue;
                 }
+                fileQ.finish();
 
                 // File is new or has been modified since last check.
                 try {
-                    const auto romType = Rom::guessType(filePath);
                     // Add rom info to database.
-                    const auto rom = Rom::create(romType);
-                    rom->loadFromFile(filePath);
-                    if (!romInfo.has_value()) {
-                        // New ROM.
-                        romInfo.emplace();
+                    const std::unique_ptr<Rom> rom(Rom::createFromFile(filePath));
+                    rom->updateRomInfo(romInfo);
+                    const auto patchTable = rom->toPatchTable();
+                    romInfo.setSignature(RomSimilarity::signature(PatchTableView(patchTable)));
+                    if (romId.has_value()) {
+                        romInfo.bind(updateRomInfoQ, 0);
+                        updateRomInfoQ.bindValue(static_cast<int>(RomInfo::kDataColumns.size()), *romId);
+                        updateRomInfoQ.exec();
+                        clearSimilarityQ.bindValue(0, *romId);
+                        clearSimilarityQ.exec();
+                    }
+                    else {
+                        insertRomInfoQ.bindValue(0, dirId);
+                        insertRomInfoQ.bindValue(1, fileName);
+                        romInfo.bind(insertRomInfoQ, 2);
+                        insertRomInfoQ.exec();
+                        romId = insertRomInfoQ.lastInsertId().toLongLong();
                     }
-                    rom->updateRomInfo(*romInfo);
-                    romInfo->setFilePath(filePath);
-                    romInfo->setFileMTime(fileMTime);
-                    romInfo->bind(saveRomInfoQ, 0);
-                    saveRomInfoQ.exec();
-                    foundOnDisk.push_back(filePath);
-                    rom->deleteLater();
+                    savePatchTableQ.bindValue(0, *romId);
+                    savePatchTableQ.bindValue(1, qCompress(patchTable));
+                    savePatchTableQ.exec();
+                    indexPatch(*romId, *rom);
+                    indexBands(*romId, romInfo.getSignature());
+                    foundOnDisk.insert(*romId);
                 }
                 catch (const InvalidRomException &) {
                     // Not a ROM file; move on.
@@ -235,33 +399,43 @@ QFuture<QList<RomInfo>> RomLibrary::getAllRoms(const QStringList &searchPaths)
             }
         }
         if (promise.isCanceled()) {
+            db.commit();
             return;
         }
 
         // Prune deleted ROMs from database.
-        QSqlQuery pruneQ(
-            QString("DELETE FROM %1 WHERE %2 NOT IN (%3)")
-                .arg(RomInfo::kTable)
-                .arg(RomInfo::kColFilePath)
-                .arg(QStringList(foundOnDisk.size(), "?").join(", "))
-        );
-        for (const auto &path : foundOnDisk) {
-            pruneQ.addBindValue(path);
+        QList<qint64> pruneIds;
+        {
+            QSqlQuery idQ;
+            idQ.exec(QString("SELECT %1 FROM %2;").arg(RomInfo::kColId, RomInfo::kTable));
+            while (idQ.next()) {
+                const auto id = idQ.value(0).toLongLong();
+                if (!foundOnDisk.contains(id)) {
+                    pruneIds.push_back(id);
+                }
+            }
+        }
+        QSqlQuery pruneQ;
+        pruneQ.prepare(QString("DELETE FROM %1 WHERE %2 = ?;").arg(RomInfo::kTable, RomInfo::kColId));
+        for (const auto id : pruneIds) {
+            pruneQ.bindValue(0, id);
+            pruneQ.exec();
         }
-        pruneQ.exec();
+        QSqlQuery pruneDirsQ;
+        pruneDirsQ.exec(
+            QString("DELETE FROM %1 WHERE id NOT IN (SELECT %2 FROM %3);")
+                .arg(RomInfo::kDirTable, RomInfo::kColDirId, RomInfo::kTable)
+        );
+        db.commit();
         promise.setProgressValue(fileCount);
 
         // Return found ROMs.
         auto roms = []()
         {
             QList<RomInfo> result;
-            QSqlQuery q(
-                QString("SELECT %1 FROM %2;")
-                    .arg(RomInfo::kAllColumns.join(", "))
-                    .arg(RomInfo::kTable)
-            );
-            q.exec();
-            result.reserve(q.size());
+            QSqlQuery q;
+            q.setForwardOnly(true);
+            q.exec(RomInfo::getSelectSql());
             while (q.next()) {
                 result.push_back(RomInfo::hydrate(q));
             }
@@ -270,25 +444,29 @@ QFuture<QList<RomInfo>> RomLibrary::getAllRoms(const QStringList &searchPaths)
         }();
         promise.addResult(roms);
     });
+    lastScan_ = ScanJob{searchPaths, future, std::move(started)};
+
+    return future;
 }
 
 QFuture<QList<RomInfo>> RomLibrary::getDuplicates(const RomInfo &romInfo)
 {
     const auto &patchHash = romInfo.getPatchHash();
-    return QtConcurrent::run(&pool_, [patchHash](QPromise<QList<RomInfo>> &promise)
+    return scheduleJob(getReadPool(), Priority::Interactive, [patchHash](QPromise<QList<RomInfo>> &promise)
     {
         QList<RomInfo> duplicates;
-        QSqlQuery q(
-            QString("SELECT %1 FROM %2 WHERE %3 = ?")
+        QSqlQuery q(getReadDatabase());
+        q.setForwardOnly(true);
+        q.prepare(
+            QString("%1 WHERE %2.%3 = ?")
                 .arg(
-                    RomInfo::kAllColumns.join(", "),
+                    RomInfo::getSelectSql(),
                     RomInfo::kTable,
                     RomInfo::kColPatchHash
                 )
         );
         q.bindValue(0, patchHash);
         q.exec();
-        duplicates.reserve(q.size());
         while (q.next()) {
             duplicates.push_back(RomInfo::hydrate(q));
         }
@@ -296,6 +474,400 @@ QFuture<QList<RomInfo>> RomLibrary::getDuplicates(const RomInfo &romInfo)
     });
 }
 
+QFuture<QList<SimilarRom>> RomLibrary::getSimilar(const RomInfo &romInfo, unsigned int maxLugEdits)
+{
+    return scheduleJob(
+        getReadPool(), Priority::Interactive, [romInfo, maxLugEdits](QPromise<QList<SimilarRom>> &promise)
+        {
+            QList<SimilarRom> similar;
+            const auto db = getReadDatabase();
+            QSqlQuery patchTableQ(db);
+            patchTableQ.setForwardOnly(true);
+            patchTableQ.prepare(
+                QString("SELECT %1 FROM %2 WHERE %3 = ?;")
+                    .arg(RomInfo::kColPatchTable, RomInfo::kPatchTable, RomInfo::kColRomId)
+            );
+            const auto loadPatchTable = [&patchTableQ](qint64 romId)
+            {
+                patchTableQ.bindValue(0, romId);
+                patchTableQ.exec();
+                QByteArray patchTable;
+                if (patchTableQ.next()) {
+                    patchTable = qUncompress(patchTableQ.value(0).toByteArray());
+                }
+                patchTableQ.finish();
+                return patchTable;
+            };
+            const auto patchTable = loadPatchTable(romInfo.getId());
+            std::optional<PatchTableView> patchTableView;
+            try {
+                patchTableView.emplace(patchTable);
+            }
+            catch (const InvalidRomException &) {
+                // Not in the library (yet).
+                promise.addResult(similar);
+                return;
+            }
+
+            // Candidates share at least one band with this ROM. Exact duplicates always share every band, but are
+            // matched by hash as well in case their signatures predate a change in the signature algorithm.
+            const auto bandHashes = RomSimilarity::bandHashes(romInfo.getSignature());
+            QSqlQuery q(db);
+            q.setForwardOnly(true);
+            q.prepare(
+                QString("%1 WHERE %2.%3 = ? AND %2.%4 != ? AND (%2.%5 = ? OR %2.%4 IN (SELECT %6 FROM %7 WHERE %8 IN (%9)))")
+                    .arg(RomInfo::getSelectSql(), RomInfo::kTable, RomInfo::kColRomType, RomInfo::kColId,
+                         RomInfo::kColPatchHash, RomInfo::kColRomId, RomInfo::kLshTable, RomInfo::kColBandHash)
+                    .arg(bandHashes.empty() ? QString("NULL") : QStringList(bandHashes.size(), "?").join(", "))
+            );
+            int pos = 0;
+            q.bindValue(pos++, romInfo.getRomType());
+            q.bindValue(pos++, romInfo.getId());
+            q.bindValue(pos++, romInfo.getPatchHash());
+            for (const auto bandHash : bandHashes) {
+                q.bindValue(pos++, bandHash);
+            }
+            q.exec();
+            QList<RomInfo> candidates;
+            while (q.next()) {
+                candidates.push_back(RomInfo::hydrate(q));
+            }
+
+            // Verify each candidate; banding finds likely matches, not certain ones.
+            for (const auto &candidate : candidates) {
+                if (promise.isCanceled()) {
+                    return;
+                }
+                const auto candidatePatchTable = loadPatchTable(candidate.getId());
+                try {
+                    const auto lugEdits =
+                        RomSimilarity::countLugEdits(*patchTableView, PatchTableView(candidatePatchTable));
+                    if (lugEdits <= maxLugEdits) {
+                        similar.push_back(SimilarRom{candidate, lugEdits});
+                    }
+                }
+                catch (const InvalidRomException &) {
+                    continue;
+                }
+            }
+            std::stable_sort(similar.begin(), similar.end(), [](const SimilarRom &lhs, const SimilarRom &rhs)
+            {
+                return lhs.lugEdits < rhs.lugEdits;
+            });
+            promise.addResult(similar);
+        });
+}
+
+QFuture<void> RomLibrary::getSimilarityMatrix(SimilarityConsumer consumer)
+{
+    // Compare on a thread of its own. The database is only touched by short jobs on the read pool, so reads and scans
+    // can run between them instead of waiting for the whole matrix.
+    return scheduleJob(&similarityPool_, Priority::Maintenance, [this, consumer](QPromise<void> &promise)
+    {
+        static const qsizetype kChunkRows = 64;
+        static const qsizetype kTileColumns = 256;
+        static const qsizetype kSaveBatchSize = 10000;
+
+        // Run @p query on the read pool and wait for its result. Waiting on a std::future instead of the QFuture keeps
+        // Qt from running the job on this thread, away from its connection.
+        const auto read = [this](auto query)
+        {
+            using Result = decltype(query());
+            auto result = std::make_shared<std::promise<Result>>();
+            auto resultFuture = result->get_future();
+            scheduleJob(getReadPool(), Priority::Maintenance, [query, result]()
+            {
+                result->set_value(query());
+            });
+            return resultFuture.get();
+        };
+        // Placeholders for binding @p count values to an IN clause.
+        const auto placeholders = [](qsizetype count)
+        {
+            return QStringList(count, "?").join(", ");
+        };
+        const auto loadPatchTables = [&read, &placeholders](const QList<qint64> &ids)
+        {
+            return read([ids, sql = QString("SELECT %1, %2 FROM %3 WHERE %1 IN (%4);")
+                .arg(RomInfo::kColRomId, RomInfo::kColPatchTable, RomInfo::kPatchTable, placeholders(ids.size()))]()
+            {
+                QHash<qint64, QByteArray> patchTables;
+                QSqlQuery q(getReadDatabase());
+                q.setForwardOnly(true);
+                q.prepare(sql);
+                for (qsizetype ix = 0; ix < ids.size(); ++ix) {
+                    q.bindValue(static_cast<int>(ix), ids.at(ix));
+                }
+                q.exec();
+                while (q.next()) {
+                    patchTables.insert(q.value(0).toLongLong(), qUncompress(q.value(1).toByteArray()));
+                }
+                return patchTables;
+            });
+        };
+
+        // Only ROMs with the same type and rack count are compared. Patch tables are loaded as they are compared, so
+        // only IDs are held for the whole library.
+        const auto [blocks, romPaths] = read([]()
+        {
+            QMap<std::pair<int, unsigned int>, QList<qint64>> blocks;
+            QHash<qint64, QString> romPaths;
+            QSqlQuery q(getReadDatabase());
+            q.setForwardOnly(true);
+            q.exec(QString("%1 ORDER BY %2.%3;").arg(RomInfo::getSelectSql(), RomInfo::kTable, RomInfo::kColId));
+            while (q.next()) {
+                const auto romInfo = RomInfo::hydrate(q);
+                romPaths.insert(romInfo.getId(), romInfo.getFilePath());
+                blocks[{romInfo.getRomType(), romInfo.getRackCount()}].push_back(romInfo.getId());
+            }
+            return std::make_pair(blocks, romPaths);
+        });
+
+        // Progress is reported in pairs, scaled down when there are more than fit in an int.
+        qint64 pairCount = 0;
+        for (const auto &block : blocks) {
+            pairCount += static_cast<qint64>(block.size()) * (block.size() - 1) / 2;
+        }
+        const auto progressScale = pairCount / std::numeric_limits<int>::max() + 1;
+        promise.setProgressRange(0, static_cast<int>(pairCount / progressScale));
+
+        // One row per ROM, comparing it with every later ROM in its block.
+        struct Row
+        {
+            qsizetype ix;
+            qint64 id;
+            QByteArray patchTable;
+            /** Cached similarity to later ROMs, by ID. */
+            QHash<qint64, double> cached;
+            QList<RomPairSimilarity> pairs;
+            /** Pairs that were not cached. */
+            QList<RomPairSimilarity> computed;
+        };
+        QList<RomPairSimilarity> unsaved;
+        qint64 progress = 0;
+        for (const auto &ids : blocks) {
+            for (qsizetype chunkStart = 0; chunkStart < ids.size() && !promise.isCanceled();
+                 chunkStart += kChunkRows) {
+                const auto chunkIds = ids.mid(chunkStart, kChunkRows);
+                QList<Row> chunk;
+                chunk.reserve(chunkIds.size());
+                {
+                    const auto patchTables = loadPatchTables(chunkIds);
+                    for (qsizetype ix = 0; ix < chunkIds.size(); ++ix) {
+                        chunk.push_back(Row{chunkStart + ix, chunkIds.at(ix), patchTables.value(chunkIds.at(ix)), {}, {},
+                                            {}});
+                    }
+                }
+                const auto cached = read([chunkIds, sql = QString("SELECT %1, %2, %3 FROM %4 WHERE %1 IN (%5);")
+                    .arg(RomInfo::kColRomA, RomInfo::kColRomB, RomInfo::kColSimilarity, RomInfo::kSimilarityTable,
+                         placeholders(chunkIds.size()))]()
+                {
+                    QHash<qint64, QHash<qint64, double>> cached;
+                    QSqlQuery q(getReadDatabase());
+                    q.setForwardOnly(true);
+                    q.prepare(sql);
+                    for (qsizetype ix = 0; ix < chunkIds.size(); ++ix) {
+                        q.bindValue(static_cast<int>(ix), chunkIds.at(ix));
+                    }
+                    q.exec();
+                    while (q.next()) {
+                        cached[q.value(0).toLongLong()].insert(q.value(1).toLongLong(), q.value(2).toDouble());
+                    }
+                    return cached;
+                });
+                for (auto &row : chunk) {
+                    row.cached = cached.value(row.id);
+                }
+
+                // Compare the chunk with a tile of later ROMs at a time, so only those patch tables are in memory.
+                for (qsizetype tileStart = chunkStart + 1; tileStart < ids.size() && !promise.isCanceled();
+                     tileStart += kTileColumns) {
+                    const auto tileIds = ids.mid(tileStart, kTileColumns);
+                    const auto needsCompare = std::ranges::any_of(chunk, [&tileIds, tileStart](const Row &row)
+                    {
+                        for (qsizetype ix = std::max<qsizetype>(row.ix + 1 - tileStart, 0); ix < tileIds.size(); ++ix) {
+                            if (!row.cached.contains(tileIds.at(ix))) {
+                                return true;
+                            }
+                        }
+                        return false;
+                    });
+                    const auto tilePatchTables = needsCompare ? loadPatchTables(tileIds) : QHash<qint64, QByteArray>();
+                    QtConcurrent::blockingMap(QThreadPool::globalInstance(), chunk,
+                                              [&promise, &tileIds, &tilePatchTables, tileStart](Row &row)
+                    {
+                        std::optional<PatchTableView> lhsView;
+                        for (qsizetype ix = std::max<qsizetype>(row.ix + 1 - tileStart, 0); ix < tileIds.size(); ++ix) {
+                            if (promise.isCanceled()) {
+                                return;
+                            }
+                            const auto rhsId = tileIds.at(ix);
+                            const auto cachedIt = row.cached.constFind(rhsId);
+                            if (cachedIt != row.cached.cend()) {
+                                row.pairs.push_back(RomPairSimilarity{row.id, rhsId, *cachedIt});
+                                continue;
+                            }
+                            try {
+                                if (!lhsView.has_value()) {
+                                    lhsView.emplace(row.patchTable);
+                                }
+                                const auto similarity =
+                                    RomSimilarity::similarity(*lhsView, PatchTableView(tilePatchTables.value(rhsId)));
+                                row.computed.push_back(RomPairSimilarity{row.id, rhsId, similarity});
+                            }
+                            catch (const InvalidRomException &) {
+                                // No usable patch table stored for one of these ROMs.
+                                continue;
+                            }
+                        }
+                    });
+                }
+                if (promise.isCanceled()) {
+                    break;
+                }
+
+                for (const auto &row : chunk) {
+                    consumer(row.pairs + row.computed, romPaths);
+                    unsaved.append(row.computed);
+                    progress += ids.size() - row.ix - 1;
+                }
+                promise.setProgressValue(static_cast<int>(progress / progressScale));
+                if (unsaved.size() >= kSaveBatchSize) {
+                    saveSimilarities(std::exchange(unsaved, {}));
+                }
+            }
+        }
+        // Keep what was compared, even if cancelled.
+        if (!unsaved.empty()) {
+            saveSimilarities(std::move(unsaved));
+        }
+    });
+}
+
+void RomLibrary::saveSimilarities(QList<RomPairSimilarity> pairs)
+{
+    scheduleJob(&pool_, Priority::Maintenance, [pairs = std::move(pairs)]()
+    {
+        auto db = QSqlDatabase::database();
+        db.transaction();
+        QSqlQuery saveQ;
+        saveQ.prepare(
+            QString("INSERT OR REPLACE INTO %1(%2, %3, %4) VALUES(?, ?, ?);")
+                .arg(RomInfo::kSimilarityTable, RomInfo::kColRomA, RomInfo::kColRomB, RomInfo::kColSimilarity)
+        );
+        for (const auto &pair : pairs) {
+            saveQ.bindValue(0, pair.lhs);
+            saveQ.bindValue(1, pair.rhs);
+            saveQ.bindValue(2, pair.similarity);
+            // Fails harmlessly if either ROM was removed since it was compared.
+            saveQ.exec();
+        }
+        db.commit();
+    });
+}
+
+QFuture<QByteArray> RomLibrary::getPatchTable(const RomInfo &romInfo)
+{
+    const auto romId = romInfo.getId();
+    return scheduleJob(getReadPool(), Priority::Interactive, [romId](QPromise<QByteArray> &promise)
+    {
+        QSqlQuery q(getReadDatabase());
+        q.setForwardOnly(true);
+        q.prepare(
+            QString("SELECT %1 FROM %2 WHERE %3 = ?;")
+                .arg(RomInfo::kColPatchTable, RomInfo::kPatchTable, RomInfo::kColRomId)
+        );
+        q.bindValue(0, romId);
+        q.exec();
+        if (q.next()) {
+            promise.addResult(qUncompress(q.value(0).toByteArray()));
+        }
+        else {
+            promise.addResult(QByteArray());
+        }
+    });
+}
+
+QFuture<QList<AddressMatch>> RomLibrary::findAddress(unsigned int address, std::optional<unsigned int> rack)
+{
+    return scheduleJob(getReadPool(), Priority::Interactive, [address, rack](QPromise<QList<AddressMatch>> &promise)
+    {
+        QList<AddressMatch> matches;
+        QSqlQuery q(getReadDatabase());
+        q.setForwardOnly(true);
+        // Both forms are a range scan of the index's primary key.
+        auto sql = QString("SELECT %1, %2, %3, %4 FROM %5 WHERE %6 = ?")
+            .arg(RomInfo::kColRomId, RomInfo::kColRack, RomInfo::kColLug, RomInfo::kColCircuit,
+                 RomInfo::kPatchIndexTable, RomInfo::kColAddress);
+        if (rack.has_value()) {
+            sql.append(QString(" AND %1 = ?").arg(RomInfo::kColRack));
+        }
+        sql.append(QString(" ORDER BY %1, %2, %3;").arg(RomInfo::kColRomId, RomInfo::kColRack, RomInfo::kColLug));
+        q.prepare(sql);
+        q.bindValue(0, address);
+        if (rack.has_value()) {
+            q.bindValue(1, *rack);
+        }
+        q.exec();
+        while (q.next()) {
+            matches.push_back(AddressMatch{
+                .romId = q.value(0).toLongLong(),
+                .rack = q.value(1).toUInt(),
+                .lug = q.value(2).toUInt(),
+                .circuit = q.value(3).toUInt(),
+            });
+        }
+        promise.addResult(matches);
+    });
+}
+
+QFuture<QHash<QByteArray, unsigned int>> RomLibrary::getPatchHashCounts()
+{
+    return scheduleJob(getReadPool(), Priority::Interactive, [](QPromise<QHash<QByteArray, unsigned int>> &promise)
+    {
+        QHash<QByteArray, unsigned int> counts;
+        QSqlQuery q(getReadDatabase());
+        q.setForwardOnly(true);
+        q.exec(
+            QString("SELECT %1, COUNT(*) FROM %2 GROUP BY %1;")
+                .arg(RomInfo::kColPatchHash, RomInfo::kTable)
+        );
+        while (q.next()) {
+            counts.insert(q.value(0).toByteArray(), q.value(1).toUInt());
+        }
+        promise.addResult(counts);
+    });
+}
+
+QThreadPool *RomLibrary::getReadPool()
+{
+    if (getDbPath() == ":memory:") {
+        return &pool_;
+    }
+    return &readPool_;
+}
+
+QSqlDatabase RomLibrary::getReadDatabase()
+{
+    const auto dbPath = getDbPath();
+    if (dbPath == ":memory:") {
+        return QSqlDatabase::database();
+    }
+
+    const auto connName = QString("patchman_read_%1").arg(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+    if (QSqlDatabase::contains(connName)) {
+        return QSqlDatabase::database(connName);
+    }
+    auto db = QSqlDatabase::addDatabase("QSQLITE", connName);
+    db.setDatabaseName(dbPath);
+    // Wait out the brief locks taken during WAL checkpoints instead of failing.
+    db.setConnectOptions("QSQLITE_OPEN_READONLY;QSQLITE_BUSY_TIMEOUT=5000");
+    if (!db.open()) {
+        qCritical() << "Failed to open read connection to browser database:" << db.lastError();
+    }
+    return db;
+}
+
 QString RomLibrary::getDbPath()
 {
     // Use an env var for this path to facilitate testing.
@@ -322,6 +894,8 @@ void RomLibrary::deleteDbFile()
 
     if (dbPath != ":memory:") {
         QFile::remove(dbPath);
+        QFile::remove(dbPath + "-wal");
+        QFile::remove(dbPath + "-shm");
     }
 }
 
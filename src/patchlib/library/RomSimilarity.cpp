@@ -0,0 +1,152 @@
+/**
+ * @file RomSimilarity.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#include "patchlib/library/RomSimilarity.h"
+#include <QtEndian>
+#include <algorithm>
+#include <array>
+#include <limits>
+
+namespace patchman::RomSimilarity
+{
+
+/**
+ * Finalizer from SplitMix64; cheap, and every input bit affects every output bit.
+ */
+static constexpr uint64_t mix64(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return x;
+}
+
+/**
+ * One seed per hash function. These are stored in the library, so changing them requires a new library version.
+ */
+static constexpr std::array<uint64_t, kHashCount> kSeeds = []()
+{
+    std::array<uint64_t, kHashCount> seeds{};
+    uint64_t state = 0x50544348;
+    for (auto &seed : seeds) {
+        state += 0x9E3779B97F4A7C15ULL;
+        seed = mix64(state);
+    }
+    return seeds;
+}();
+
+QByteArray signature(const PatchTableView &patchTable)
+{
+    std::array<uint32_t, kHashCount> mins;
+    mins.fill(std::numeric_limits<uint32_t>::max());
+    const auto &racks = patchTable.getRacks();
+    for (unsigned int rackNum = 0; rackNum < racks.size(); ++rackNum) {
+        const auto &rack = racks.at(rackNum);
+        for (unsigned int lug = 0; lug < rack.getLugCount(); ++lug) {
+            const uint64_t element = (uint64_t(rackNum) << 32) | (uint64_t(lug) << 16) | rack.getLugWord(lug);
+            for (unsigned int ix = 0; ix < kHashCount; ++ix) {
+                mins[ix] = std::min(mins[ix], static_cast<uint32_t>(mix64(element ^ kSeeds[ix]) >> 32));
+            }
+        }
+    }
+
+    QByteArray data(kHashCount * sizeof(uint32_t), Qt::Uninitialized);
+    for (unsigned int ix = 0; ix < kHashCount; ++ix) {
+        qToLittleEndian(mins[ix], data.data() + ix * sizeof(uint32_t));
+    }
+    return data;
+}
+
+QList<qint64> bandHashes(const QByteArray &signature)
+{
+    if (signature.size() != static_cast<qsizetype>(kHashCount * sizeof(uint32_t))) {
+        return {};
+    }
+    QList<qint64> hashes;
+    hashes.reserve(kBandCount);
+    for (unsigned int band = 0; band < kBandCount; ++band) {
+        // Include the band number so equal rows in different bands don't match.
+        uint64_t hash = mix64(band);
+        for (unsigned int row = 0; row < kRowsPerBand; ++row) {
+            const auto pos = (band * kRowsPerBand + row) * sizeof(uint32_t);
+            hash = mix64(hash ^ qFromLittleEndian<uint32_t>(signature.constData() + pos));
+        }
+        hashes.push_back(static_cast<qint64>(hash));
+    }
+    return hashes;
+}
+
+/**
+ * Call @p function with the rack number, number of lugs patched in either table, and number of differing lugs of each
+ * rack in either table.
+ *
+ * A rack or lug missing from one table is compared as unpatched.
+ */
+template<typename Function>
+static void forEachRackEdits(const PatchTableView &lhs, const PatchTableView &rhs, Function &&function)
+{
+    const auto &lhsRacks = lhs.getRacks();
+    const auto &rhsRacks = rhs.getRacks();
+    const auto rackCount = std::max(lhsRacks.size(), rhsRacks.size());
+    for (qsizetype rackNum = 0; rackNum < rackCount; ++rackNum) {
+        const auto lhsLugCount = rackNum < lhsRacks.size() ? lhsRacks.at(rackNum).getLugCount() : 0;
+        const auto rhsLugCount = rackNum < rhsRacks.size() ? rhsRacks.at(rackNum).getLugCount() : 0;
+        const auto commonLugCount = std::min(lhsLugCount, rhsLugCount);
+        unsigned int patched = 0;
+        unsigned int edits = 0;
+        for (unsigned int lug = 0; lug < commonLugCount; ++lug) {
+            const auto lhsWord = lhsRacks.at(rackNum).getLugWord(lug);
+            const auto rhsWord = rhsRacks.at(rackNum).getLugWord(lug);
+            if (lhsWord != 0 || rhsWord != 0) {
+                ++patched;
+            }
+            if (lhsWord != rhsWord) {
+                ++edits;
+            }
+        }
+        if (lhsLugCount != rhsLugCount) {
+            const auto &longer = lhsLugCount > rhsLugCount ? lhsRacks.at(rackNum) : rhsRacks.at(rackNum);
+            for (unsigned int lug = commonLugCount; lug < longer.getLugCount(); ++lug) {
+                if (longer.getLugWord(lug) != 0) {
+                    ++patched;
+                    ++edits;
+                }
+            }
+        }
+        function(static_cast<unsigned int>(rackNum), patched, edits);
+    }
+}
+
+unsigned int countLugEdits(const PatchTableView &lhs, const PatchTableView &rhs)
+{
+    unsigned int edits = 0;
+    forEachRackEdits(lhs, rhs, [&edits](unsigned int, unsigned int, unsigned int rackEdits)
+    {
+        edits += rackEdits;
+    });
+    return edits;
+}
+
+double similarity(const PatchTableView &lhs, const PatchTableView &rhs)
+{
+    double total = 0;
+    unsigned int rackCount = 0;
+    forEachRackEdits(lhs, rhs, [&total, &rackCount](unsigned int, unsigned int patched, unsigned int rackEdits)
+    {
+        // Racks unpatched in both tables say nothing about how alike the patches are.
+        if (patched > 0) {
+            total += 1.0 - static_cast<double>(rackEdits) / patched;
+            ++rackCount;
+        }
+    });
+    return rackCount > 0 ? total / rackCount : 1.0;
+}
+
+} // patchman::RomSimilarity
@@ -0,0 +1,159 @@
+/**
+ * @file BatchReport.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#include "BatchReport.h"
+#include "ReportBuilder.h"
+#include "SystemReportBuilder.h"
+#include "patchlib/Exceptions.h"
+#include <QtConcurrent>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <QSet>
+#include <memory>
+
+namespace patchman
+{
+
+QStringList BatchReport::findFiles(const QStringList &paths)
+{
+    QStringList files;
+    for (const auto &path : paths) {
+        if (!QFileInfo(path).isDir()) {
+            files.push_back(path);
+            continue;
+        }
+        for (QDirIterator it(path, QDir::Readable | QDir::Files | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+             it.hasNext();) {
+            files.push_back(it.next());
+        }
+    }
+    return files;
+}
+
+QFuture<BatchReport::Result> BatchReport::create(const QStringList &romPaths, const QString &outputDir)
+{
+    // Pick every report name up front so ROMs with the same name in different directories don't collide.
+    struct Job
+    {
+        QString romPath;
+        QString reportPath;
+    };
+    QList<Job> jobs;
+    jobs.reserve(romPaths.size());
+    QSet<QString> reportNames;
+    const QDir dir(outputDir);
+    for (const auto &romPath : romPaths) {
+        const auto baseName = QFileInfo(romPath).completeBaseName();
+        auto reportName = QString("%1.html").arg(baseName);
+        for (int suffix = 2; reportNames.contains(reportName.toLower()); ++suffix) {
+            reportName = QString("%1-%2.html").arg(baseName).arg(suffix);
+        }
+        reportNames.insert(reportName.toLower());
+        jobs.push_back({romPath, dir.filePath(reportName)});
+    }
+
+    return QtConcurrent::mapped(jobs, [](const Job &job)
+    {
+        Result result{.romPath = job.romPath};
+        try {
+            const std::unique_ptr<Rom> rom(Rom::createFromFile(job.romPath));
+            const std::unique_ptr<ReportBuilder> builder(ReportBuilder::create(rom.get()));
+            QSaveFile reportFile(job.reportPath);
+            if (!reportFile.open(QSaveFile::WriteOnly | QSaveFile::Text)
+                || !builder->createReport(&reportFile)
+                || !reportFile.commit()) {
+                result.error = reportFile.errorString();
+                return result;
+            }
+        }
+        catch (const InvalidRomException &e) {
+            result.status = Result::Status::NotRom;
+            result.error = e.getMessage();
+            return result;
+        }
+        catch (const std::exception &e) {
+            result.error = QString::fromStdString(e.what());
+            return result;
+        }
+        result.status = Result::Status::Created;
+        result.reportPath = job.reportPath;
+        return result;
+    });
+}
+
+QFuture<BatchReport::Result> BatchReport::createSystem(const QStringList &romPaths, const QString &reportPath)
+{
+    auto loading = QtConcurrent::mapped(romPaths, [](const QString &romPath)
+    {
+        try {
+            return std::shared_ptr<Rom>(Rom::createFromFile(romPath));
+        }
+        catch (const InvalidRomException &) {
+            return std::shared_ptr<Rom>();
+        }
+    });
+    return loading.then([romPaths, reportPath](QFuture<std::shared_ptr<Rom>> loaded)
+    {
+        Result result;
+        try {
+            // Rethrows any error reading the files.
+            const auto loadedRoms = loaded.results();
+            // ROMs are labelled by file name, with the directory added when a name is used more than once.
+            QHash<QString, int> fileNameCounts;
+            for (qsizetype ix = 0; ix < loadedRoms.size(); ++ix) {
+                if (loadedRoms[ix]) {
+                    ++fileNameCounts[QFileInfo(romPaths[ix]).fileName().toLower()];
+                }
+            }
+            QList<std::pair<QString, const Rom *>> roms;
+            QSet<QString> labels;
+            for (qsizetype ix = 0; ix < loadedRoms.size(); ++ix) {
+                if (!loadedRoms[ix]) {
+                    continue;
+                }
+                const QFileInfo romFile(romPaths[ix]);
+                auto baseLabel = romFile.fileName();
+                if (fileNameCounts.value(baseLabel.toLower()) > 1) {
+                    baseLabel = QDir(romFile.absoluteDir().dirName()).filePath(baseLabel);
+                }
+                auto label = baseLabel;
+                for (int suffix = 2; labels.contains(label.toLower()); ++suffix) {
+                    label = QString("%1 (%2)").arg(baseLabel).arg(suffix);
+                }
+                labels.insert(label.toLower());
+                roms.emplace_back(label, loadedRoms[ix].get());
+            }
+            if (roms.empty()) {
+                result.status = Result::Status::NotRom;
+                result.error = tr("No ROMs were found.");
+                return result;
+            }
+
+            SystemReportBuilder builder(roms);
+            QSaveFile reportFile(reportPath);
+            if (!reportFile.open(QSaveFile::WriteOnly | QSaveFile::Text)
+                || !builder.createReport(&reportFile)
+                || !reportFile.commit()) {
+                result.error = reportFile.errorString();
+                return result;
+            }
+        }
+        catch (const std::exception &e) {
+            result.error = QString::fromStdString(e.what());
+            return result;
+        }
+        result.status = Result::Status::Created;
+        result.reportPath = reportPath;
+        return result;
+    });
+}
+
+} // patchman
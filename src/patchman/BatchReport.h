@@ -0,0 +1,73 @@
+/**
+ * @file BatchReport.h
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#ifndef BATCHREPORT_H
+#define BATCHREPORT_H
+
+#include <QCoreApplication>
+#include <QFuture>
+#include <QStringList>
+
+namespace patchman
+{
+
+/**
+ * Create reports for many ROMs at once.
+ */
+class BatchReport
+{
+Q_DECLARE_TR_FUNCTIONS(BatchReport)
+public:
+    struct Result
+    {
+        enum class Status
+        {
+            Created,
+            /** The file is not a ROM. */
+            NotRom,
+            Failed,
+        };
+
+        QString romPath;
+        /** Path to the report, if it was created. */
+        QString reportPath;
+        Status status = Status::Failed;
+        QString error;
+    };
+
+    /**
+     * Find the files in @p paths, descending into directories.
+     */
+    [[nodiscard]] static QStringList findFiles(const QStringList &paths);
+
+    /**
+     * Create a report in @p outputDir for each ROM in @p romPaths, in parallel.
+     *
+     * Reports are named after their ROM files. The future reports progress, can be canceled, and has one result for
+     * each of @p romPaths in the same order.
+     *
+     * @param romPaths
+     * @param outputDir Must exist.
+     */
+    [[nodiscard]] static QFuture<Result> create(const QStringList &romPaths, const QString &outputDir);
+
+    /**
+     * Create one system report at @p reportPath combining every ROM in @p romPaths.
+     *
+     * ROMs are loaded in parallel. Files that are not ROMs are left out of the report.
+     *
+     * @param romPaths
+     * @param reportPath
+     * @return A future with one result. Its romPath is empty.
+     */
+    [[nodiscard]] static QFuture<Result> createSystem(const QStringList &romPaths, const QString &reportPath);
+};
+
+} // patchman
+
+#endif //BATCHREPORT_H
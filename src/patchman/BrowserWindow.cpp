@@ -8,6 +8,7 @@
 
 #include "BrowserWindow.h"
 #include "EditorWindow.h"
+#include "patchlib/EditJournal.h"
 #include "patchlib/Exceptions.h"
 #include "util.h"
 #include "Settings.h"
@@ -15,8 +16,11 @@
 #include "patchman_config.h"
 #include "SettingsDialog.h"
 #include "ReportBuilder.h"
+#include "BatchReport.h"
 #include "showPathInFileBrowser.h"
 #include "ShowDuplicatesDialog.h"
+#include "RomDiffDialog.h"
+#include "RackPreview.h"
 #include "patchlib/library/RomLibrary.h"
 #include "help.h"
 #include "updater.h"
@@ -28,18 +32,36 @@
 #include <QCloseEvent>
 #include <QStatusBar>
 #include <QClipboard>
+#include <QDebug>
+#include <QDockWidget>
+#include <QToolBar>
+#include <QProgressDialog>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QTimer>
+#include <memory>
 
 #include "qiconFromTheme.h"
 
 namespace patchman
 {
 
+/**
+ * Check that the file at @p filePath hasn't changed since the library stored it with @p fileMTimeNs.
+ */
+static bool isStoredPatchTableCurrent(const QString &filePath, qint64 fileMTimeNs)
+{
+    // Scans store the modification time at the same millisecond precision.
+    return QFileInfo(filePath).lastModified().toMSecsSinceEpoch() * 1'000'000 == fileMTimeNs;
+}
+
 BrowserWindow::BrowserWindow(QWidget *parent)
     : QMainWindow(parent)
 {
     initMenus();
     initWidgets();
     initFsWatcher();
+    QTimer::singleShot(0, this, &BrowserWindow::recoverEdits);
 
     if (Settings::GetRomSearchPaths().empty()) {
         QMessageBox::information(this,
@@ -80,6 +102,14 @@ void BrowserWindow::initMenus()
     actions_.fileCreateReport->setIcon(qiconFromTheme("office-report"));
     connect(actions_.fileCreateReport, &QAction::triggered, this, &BrowserWindow::createReport);
     menuFile->addAction(actions_.fileCreateReport);
+    // Create System Report
+    actions_.fileCreateSystemReport = new QAction(tr("Create &System Report..."), this);
+    connect(actions_.fileCreateSystemReport, &QAction::triggered, this, &BrowserWindow::createSystemReport);
+    menuFile->addAction(actions_.fileCreateSystemReport);
+    // Export Similarity
+    actions_.fileExportSimilarity = new QAction(tr("&Export Similarity..."), this);
+    connect(actions_.fileExportSimilarity, &QAction::triggered, this, &BrowserWindow::exportSimilarity);
+    menuFile->addAction(actions_.fileExportSimilarity);
     // ------
     menuFile->addSeparator();
     // Settings
@@ -108,6 +138,10 @@ void BrowserWindow::initMenus()
     actions_.editShowDuplicates->setIcon(qiconFromTheme("document-duplicate"));
     connect(actions_.editShowDuplicates, &QAction::triggered, this, &BrowserWindow::showDuplicates);
     menuEdit->addAction(actions_.editShowDuplicates);
+    // Compare
+    actions_.editCompare = new QAction(tr("Co&mpare With..."), this);
+    connect(actions_.editCompare, &QAction::triggered, this, &BrowserWindow::compareRom);
+    menuEdit->addAction(actions_.editCompare);
     // Show In File Browser
     actions_.editShowInFileBrowser = new QAction(tr("&Show in Explorer"), this);
     actions_.editShowInFileBrowser->setIcon(qiconFromTheme("system-file-manager"));
@@ -156,14 +190,16 @@ void BrowserWindow::initWidgets()
     widgets_.browser = new QTableView(this);
     setCentralWidget(widgets_.browser);
     browserModel_ = new RomLibraryModel(this);
-    widgets_.browser->setSelectionMode(QTableView::SingleSelection);
+    widgets_.browser->setSelectionMode(QTableView::ExtendedSelection);
     widgets_.browser->setSelectionBehavior(QTableView::SelectRows);
     widgets_.browser->setContextMenuPolicy(Qt::ActionsContextMenu);
 
     // ROM context menu actions
     widgets_.browser->addAction(actions_.editEditRom);
     widgets_.browser->addAction(actions_.fileCreateReport);
+    widgets_.browser->addAction(actions_.fileCreateSystemReport);
     widgets_.browser->addAction(actions_.editShowDuplicates);
+    widgets_.browser->addAction(actions_.editCompare);
     widgets_.browser->addAction(actions_.editShowInFileBrowser);
     widgets_.browser->addAction(actions_.editCopyChecksum);
 
@@ -177,6 +213,38 @@ void BrowserWindow::initWidgets()
             this,
             &BrowserWindow::updateActionsFromSelection);
     connect(widgets_.browser, &QTableView::doubleClicked, this, &BrowserWindow::editRom);
+    widgets_.browser->hideColumn(static_cast<int>(RomLibraryModel::Column::Matches));
+
+    // Address search
+    auto *searchToolbar = addToolBar(tr("Search"));
+    searchToolbar->setObjectName("SearchToolbar");
+    searchToolbar->addWidget(new QLabel(tr("Find DMX address:"), searchToolbar));
+    widgets_.searchAddress = new QSpinBox(searchToolbar);
+    widgets_.searchAddress->setRange(0, 512);
+    widgets_.searchAddress->setSpecialValueText(tr("Off"));
+    searchToolbar->addWidget(widgets_.searchAddress);
+    searchToolbar->addWidget(new QLabel(tr("in"), searchToolbar));
+    widgets_.searchRack = new QSpinBox(searchToolbar);
+    // Racks are numbered from 0.
+    widgets_.searchRack->setRange(-1, 15);
+    widgets_.searchRack->setPrefix(tr("Rack "));
+    widgets_.searchRack->setSpecialValueText(tr("Any rack"));
+    widgets_.searchRack->setValue(-1);
+    searchToolbar->addWidget(widgets_.searchRack);
+    connect(widgets_.searchAddress, &QSpinBox::valueChanged, this, &BrowserWindow::searchChanged);
+    connect(widgets_.searchRack, &QSpinBox::valueChanged, this, &BrowserWindow::searchChanged);
+
+    // Preview
+    widgets_.preview = new QTabWidget(this);
+    widgets_.preview->setDocumentMode(true);
+    auto *previewDock = new QDockWidget(tr("Preview"), this);
+    previewDock->setObjectName("PreviewDock");
+    previewDock->setWidget(widgets_.preview);
+    addDockWidget(Qt::RightDockWidgetArea, previewDock);
+    connect(widgets_.browser->selectionModel(),
+            &QItemSelectionModel::selectionChanged,
+            this,
+            &BrowserWindow::updatePreview);
     // Resize everything to fit on first data load.
     connect(browserModel_, &RomLibraryModel::modelReset, this, [this]()
     { widgets_.browser->resizeColumnsToContents(); }, Qt::SingleShotConnection);
@@ -192,24 +260,29 @@ void BrowserWindow::initWidgets()
     connect(browserModel_, &RomLibraryModel::progressRangeChanged, this, &BrowserWindow::progressRangeChanged);
     connect(browserModel_, &RomLibraryModel::progressValueChanged, this, &BrowserWindow::progressValueChanged);
 
+    // Report progress
+    widgets_.reportProgress = new BusyIndicator(tr("Creating report..."), this);
+    statusBar()->addPermanentWidget(widgets_.reportProgress);
+
     updateActionsFromSelection();
 }
 
 void BrowserWindow::initFsWatcher()
 {
-    fsWatcher_ = new QFileSystemWatcher(this);
-    for (const auto &searchPath : Settings::GetRomSearchPaths()) {
-        watchPath(searchPath);
+    if (libraryWatcher_ == nullptr) {
+        libraryWatcher_ = new LibraryWatcher(this);
+        connect(libraryWatcher_,
+                &LibraryWatcher::changed,
+                browserModel_,
+                &RomLibraryModel::checkForFilesystemChanges);
     }
-    connect(fsWatcher_, &QFileSystemWatcher::directoryChanged, this, &BrowserWindow::directoryChanged);
+    libraryWatcher_->setRootPaths(Settings::GetRomSearchPaths());
 }
 
 void BrowserWindow::openFrom(const QString &path)
 {
     try {
-        auto romType = Rom::guessType(path);
-        auto rom = Rom::create(romType, this);
-        rom->loadFromFile(path);
+        auto rom = Rom::createFromFile(path, this);
         showEditor(rom, path);
     }
     catch (const InvalidRomException &e) {
@@ -253,20 +326,80 @@ void BrowserWindow::updateRecentDocuments(const QString &path)
 
 void BrowserWindow::updateActionsFromSelection()
 {
-    const bool hasSelection = widgets_.browser->selectionModel()->hasSelection();
-    actions_.fileCreateReport->setEnabled(hasSelection);
+    const auto selectedCount = widgets_.browser->selectionModel()->selectedRows().size();
+    const bool hasSelection = selectedCount == 1;
+    // Reports can be created for many ROMs at once.
+    actions_.fileCreateReport->setEnabled(selectedCount > 0);
+    actions_.fileCreateSystemReport->setEnabled(selectedCount > 1);
     actions_.editEditRom->setEnabled(hasSelection);
     actions_.editShowDuplicates->setEnabled(hasSelection);
+    actions_.editCompare->setEnabled(hasSelection);
     actions_.editShowInFileBrowser->setEnabled(hasSelection);
     actions_.editCopyChecksum->setEnabled(hasSelection);
 }
 
-void BrowserWindow::showEditor(Rom *rom, const QString &path)
+void BrowserWindow::updatePreview()
+{
+    while (widgets_.preview->count() > 0) {
+        auto *page = widgets_.preview->widget(0);
+        widgets_.preview->removeTab(0);
+        page->deleteLater();
+    }
+    if (previewRom_ != nullptr) {
+        previewRom_->deleteLater();
+        previewRom_ = nullptr;
+    }
+    previewRomId_ = 0;
+    if (!widgets_.browser->selectionModel()->hasSelection()) {
+        return;
+    }
+
+    // Previews come from the library, so the ROM file is never read.
+    const auto &romInfo = getSelectedRomInfo();
+    const auto romId = romInfo.getId();
+    previewRomId_ = romId;
+    RomLibrary::get()->getPatchTable(romInfo).then(this, [this, romId](const QByteArray &patchTable)
+    {
+        if (romId != previewRomId_ || previewRom_ != nullptr || patchTable.isEmpty()) {
+            // Selection changed while loading, or the library has nothing to show.
+            return;
+        }
+        try {
+            previewRom_ = Rom::fromPatchTable(patchTable, this);
+        }
+        catch (const InvalidRomException &) {
+            return;
+        }
+        for (auto *rack : previewRom_->getRacksView()) {
+            if (!rack->isPatched()) {
+                continue;
+            }
+            auto *preview = RackPreview::create(rack, widgets_.preview);
+            if (preview != nullptr) {
+                widgets_.preview->addTab(preview, rack->getRackName());
+            }
+        }
+    });
+}
+
+void BrowserWindow::searchChanged()
+{
+    const auto address = static_cast<unsigned int>(widgets_.searchAddress->value());
+    std::optional<unsigned int> rack;
+    if (widgets_.searchRack->value() >= 0) {
+        rack = static_cast<unsigned int>(widgets_.searchRack->value());
+    }
+    browserModel_->setAddressSearch(address, rack);
+    widgets_.browser->setColumnHidden(static_cast<int>(RomLibraryModel::Column::Matches), address == 0);
+}
+
+EditorWindow *BrowserWindow::showEditor(Rom *rom, const QString &path)
 {
     auto *editor = new EditorWindow(rom, path, this);
     editors_.emplace_back(editor);
     connect(editor, &EditorWindow::destroyed, this, &BrowserWindow::editorClosed, Qt::QueuedConnection);
     editor->show();
+    return editor;
 }
 
 const RomInfo &BrowserWindow::getSelectedRomInfo() const
@@ -279,12 +412,32 @@ const RomInfo &BrowserWindow::getSelectedRomInfo() const
     return browserModel_->getRomInfoForRow(row);
 }
 
-void BrowserWindow::watchPath(const QString &path)
+QStringList BrowserWindow::getSelectedRomPaths() const
 {
-    for (QDirIterator it(path, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories); it.hasNext();) {
-        const auto &dir = it.next();
-        fsWatcher_->addPath(dir);
+    QStringList romPaths;
+    for (const auto &index : widgets_.browser->selectionModel()->selectedRows()) {
+        const auto row = sortFilterModel_->mapToSource(index).row();
+        romPaths.push_back(browserModel_->getRomInfoForRow(row).getFilePath());
     }
+    return romPaths;
+}
+
+QFuture<Rom *> BrowserWindow::loadLibraryRom(const RomInfo &romInfo)
+{
+    return RomLibrary::get()->getPatchTable(romInfo).then(
+        this,
+        [this, filePath = romInfo.getFilePath(), fileMTimeNs = romInfo.getFileMTimeNs()](const QByteArray &patchTable)
+        {
+            if (!patchTable.isEmpty() && isStoredPatchTableCurrent(filePath, fileMTimeNs)) {
+                try {
+                    return Rom::fromPatchTable(patchTable, this);
+                }
+                catch (const InvalidRomException &) {
+                    // Use the file instead.
+                }
+            }
+            return Rom::createFromFile(filePath, this);
+        });
 }
 
 void BrowserWindow::hideProgressIfComplete()
@@ -337,15 +490,180 @@ void BrowserWindow::open()
     }
 }
 
+void BrowserWindow::createReports(const QStringList &romPaths)
+{
+    const auto outputDir = QFileDialog::getExistingDirectory(this,
+                                                             tr("Save %n Report(s) In", nullptr,
+                                                                static_cast<int>(romPaths.size())),
+                                                             Settings::GetLastFileDialogPath());
+    if (outputDir.isEmpty()) {
+        return;
+    }
+    Settings::SetLastFileDialogPath(outputDir);
+
+    auto *progressDialog = new QProgressDialog(tr("Creating reports..."), tr("Cancel"), 0, 0, this);
+    progressDialog->setWindowModality(Qt::WindowModal);
+    progressDialog->setAttribute(Qt::WA_DeleteOnClose);
+    auto *watcher = new QFutureWatcher<BatchReport::Result>(progressDialog);
+    connect(watcher, &QFutureWatcherBase::progressRangeChanged, progressDialog, &QProgressDialog::setRange);
+    connect(watcher, &QFutureWatcherBase::progressValueChanged, progressDialog, &QProgressDialog::setValue);
+    connect(progressDialog, &QProgressDialog::canceled, watcher, &QFutureWatcherBase::cancel);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, progressDialog, outputDir]()
+    {
+        // Closing the dialog emits canceled(), so read the outcome first and only hide it.
+        const auto canceled = watcher->isCanceled();
+        const auto results = watcher->future().results();
+        progressDialog->hide();
+        progressDialog->deleteLater();
+        QStringList errors;
+        for (const auto &result : results) {
+            if (result.status != BatchReport::Result::Status::Created) {
+                errors.push_back(QString("%1: %2").arg(result.romPath, result.error));
+            }
+        }
+        if (!errors.empty()) {
+            QMessageBox msgBox(this);
+            msgBox.setIcon(QMessageBox::Warning);
+            msgBox.setText(tr("%n report(s) could not be created.", nullptr, static_cast<int>(errors.size())));
+            msgBox.setDetailedText(errors.join('\n'));
+            msgBox.exec();
+        }
+        if (!canceled) {
+            QDesktopServices::openUrl(QUrl::fromLocalFile(outputDir));
+        }
+    });
+    watcher->setFuture(BatchReport::create(romPaths, outputDir));
+    progressDialog->show();
+}
+
 void BrowserWindow::createReport()
 {
-    const auto romInfo = getSelectedRomInfo();
-    auto romType = Rom::guessType(romInfo.getFilePath());
-    auto rom = Rom::create(romType, this);
-    rom->loadFromFile(romInfo.getFilePath());
-    ReportBuilder *builder = ReportBuilder::create(rom, this);
-    const auto reportPath = builder->createReport();
-    QDesktopServices::openUrl(QUrl(QString("file:///%1").arg(reportPath), QUrl::TolerantMode));
+    const auto romPaths = getSelectedRomPaths();
+    if (romPaths.size() > 1) {
+        createReports(romPaths);
+        return;
+    }
+
+    const auto &romInfo = getSelectedRomInfo();
+    auto future = RomLibrary::get()->getPatchTable(romInfo).then(
+        QtFuture::Launch::Async,
+        [filePath = romInfo.getFilePath(), fileMTimeNs = romInfo.getFileMTimeNs()](const QByteArray &patchTable)
+        {
+            std::unique_ptr<Rom> rom;
+            // The stored patch table is out of date if the file changed since the last scan.
+            if (!patchTable.isEmpty() && isStoredPatchTableCurrent(filePath, fileMTimeNs)) {
+                try {
+                    rom.reset(Rom::fromPatchTable(patchTable));
+                }
+                catch (const InvalidRomException &) {
+                    // Use the file instead.
+                }
+            }
+            if (!rom) {
+                rom.reset(Rom::createFromFile(filePath));
+            }
+            return ReportBuilder::createReportFile(rom.get());
+        });
+    widgets_.reportProgress->track(future);
+    future
+        .then(this, [](const QString &reportPath)
+        {
+            QDesktopServices::openUrl(QUrl(QString("file:///%1").arg(reportPath), QUrl::TolerantMode));
+        })
+        .onFailed(this, [this](const InvalidRomException &e)
+        {
+            showExceptionMessageBox(e, this);
+        })
+        .onFailed(this, [this](const std::exception &e)
+        {
+            QMessageBox::critical(this, tr("Report could not be created."), QString::fromStdString(e.what()));
+        });
+}
+
+void BrowserWindow::createSystemReport()
+{
+    const auto romPaths = getSelectedRomPaths();
+    const auto reportPath = QFileDialog::getSaveFileName(this,
+                                                         tr("Create System Report"),
+                                                         QDir(Settings::GetLastFileDialogPath()).filePath("system.html"),
+                                                         tr("HTML files (*.html)"));
+    if (reportPath.isEmpty()) {
+        return;
+    }
+    Settings::SetLastFileDialogPath(QFileInfo(reportPath).path());
+
+    auto future = BatchReport::createSystem(romPaths, reportPath);
+    widgets_.reportProgress->track(future);
+    future.then(this, [this](const BatchReport::Result &result)
+    {
+        if (result.status != BatchReport::Result::Status::Created) {
+            QMessageBox::critical(this, tr("Report could not be created."), result.error);
+            return;
+        }
+        QDesktopServices::openUrl(QUrl::fromLocalFile(result.reportPath));
+    });
+}
+
+void BrowserWindow::exportSimilarity()
+{
+    const auto path = QFileDialog::getSaveFileName(this,
+                                                   tr("Export Similarity"),
+                                                   Settings::GetLastFileDialogPath(),
+                                                   tr("CSV files (*.csv)"));
+    if (path.isEmpty()) {
+        return;
+    }
+    Settings::SetLastFileDialogPath(QFileInfo(path).path());
+
+    // Rows are written as they arrive rather than after holding the whole matrix.
+    auto file = std::make_shared<QSaveFile>(path);
+    if (!file->open(QSaveFile::WriteOnly | QSaveFile::Text)) {
+        QMessageBox::critical(this, tr("Export failed"), file->errorString());
+        return;
+    }
+    auto out = std::make_shared<QTextStream>(file.get());
+    *out << "ROM A,ROM B,Similarity\n";
+    const auto writeRow = [out](const QList<RomPairSimilarity> &pairs, const QHash<qint64, QString> &romPaths)
+    {
+        const auto csvField = [](const QString &value)
+        {
+            auto escaped = value;
+            escaped.replace('"', "\"\"");
+            return QString("\"%1\"").arg(escaped);
+        };
+        for (const auto &pair : pairs) {
+            *out << csvField(romPaths.value(pair.lhs)) << ',' << csvField(romPaths.value(pair.rhs)) << ','
+                 << QString::number(pair.similarity, 'f', 4) << '\n';
+        }
+    };
+
+    auto *progressDialog = new QProgressDialog(tr("Comparing ROMs..."), tr("Cancel"), 0, 0, this);
+    progressDialog->setWindowModality(Qt::WindowModal);
+    progressDialog->setAttribute(Qt::WA_DeleteOnClose);
+    auto *watcher = new QFutureWatcher<void>(progressDialog);
+    connect(watcher, &QFutureWatcherBase::progressRangeChanged, progressDialog, &QProgressDialog::setRange);
+    connect(watcher, &QFutureWatcherBase::progressValueChanged, progressDialog, &QProgressDialog::setValue);
+    connect(progressDialog, &QProgressDialog::canceled, watcher, &QFutureWatcherBase::cancel);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, progressDialog, file, out]()
+    {
+        // Closing the dialog emits canceled(), so check the outcome first and only hide it.
+        const auto canceled = watcher->isCanceled();
+        progressDialog->hide();
+        progressDialog->deleteLater();
+        // Flushes the stream and stops it from outliving the file.
+        out->setDevice(nullptr);
+        if (canceled) {
+            file->cancelWriting();
+            file->commit();
+            return;
+        }
+
+        if (!file->commit()) {
+            QMessageBox::critical(this, tr("Export failed"), file->errorString());
+        }
+    });
+    watcher->setFuture(RomLibrary::get()->getSimilarityMatrix(writeRow));
+    progressDialog->show();
 }
 
 void BrowserWindow::settings()
@@ -375,6 +693,31 @@ void BrowserWindow::showDuplicates()
     dialog.exec();
 }
 
+void BrowserWindow::compareRom()
+{
+    const auto romInfo = getSelectedRomInfo();
+    const auto modifiedPath = QFileDialog::getOpenFileName(this,
+                                                           tr("Compare %1 With").arg(romInfo.getFilePath()),
+                                                           Settings::GetLastFileDialogPath());
+    if (modifiedPath.isEmpty()) {
+        return;
+    }
+    Settings::SetLastFileDialogPath(QFileInfo(modifiedPath).path());
+
+    loadLibraryRom(romInfo)
+        .then(this, [this, sourcePath = romInfo.getFilePath(), modifiedPath](Rom *sourceRom)
+        {
+            const std::unique_ptr<Rom> source(sourceRom);
+            const std::unique_ptr<Rom> modified(Rom::createFromFile(modifiedPath));
+            RomDiffDialog dialog(*source, sourcePath, *modified, modifiedPath, this);
+            dialog.exec();
+        })
+        .onFailed(this, [this](const InvalidRomException &e)
+        {
+            showExceptionMessageBox(e, this);
+        });
+}
+
 void BrowserWindow::copyChecksum()
 {
     const auto romInfo = getSelectedRomInfo();
@@ -409,16 +752,35 @@ void BrowserWindow::editorClosed()
     );
 }
 
-void BrowserWindow::directoryChanged(const QString &path)
+void BrowserWindow::recoverEdits()
 {
-    if (!QDir(path).exists()) {
-        fsWatcher_->removePath(path);
-    }
-    else {
-        // Ensure any newly-added subdirectories are monitored.
-        watchPath(path);
+    for (const auto &journalPath : EditJournal::findAbandoned()) {
+        EditJournal::Recovered recovered;
+        try {
+            recovered = EditJournal::recover(journalPath, this);
+        }
+        catch (const std::runtime_error &e) {
+            qWarning() << "Discarding unreadable journal" << journalPath << ":" << e.what();
+            EditJournal::remove(journalPath);
+            continue;
+        }
+
+        const auto romName = recovered.romPath.isEmpty()
+                             ? recovered.rom->getTitle()
+                             : QFileInfo(recovered.romPath).fileName();
+        const auto result = QMessageBox::question(
+            this,
+            tr("Recover unsaved changes?"),
+            tr("Patchman did not close normally while editing %1. Recover the unsaved changes?").arg(romName));
+        if (result == QMessageBox::Yes) {
+            // The editor starts its own journal, so this one is no longer needed.
+            showEditor(recovered.rom, recovered.romPath)->markRecovered();
+        }
+        else {
+            delete recovered.rom;
+        }
+        EditJournal::remove(journalPath);
     }
-    browserModel_->checkForFilesystemChanges();
 }
 
 void BrowserWindow::progressRangeChanged(int min, int max)
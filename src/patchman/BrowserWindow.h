@@ -9,12 +9,17 @@
 #ifndef BROWSERWINDOW_H
 #define BROWSERWINDOW_H
 
+#include <QFuture>
 #include <QMainWindow>
 #include <QTableView>
 #include <QProgressBar>
+#include <QSpinBox>
+#include <QTabWidget>
 #include "patchlib/Rom.h"
 #include "EditorWindow.h"
 #include "RomLibraryModel.h"
+#include "BusyIndicator.h"
+#include "patchlib/library/LibraryWatcher.h"
 
 namespace patchman
 {
@@ -37,10 +42,13 @@ private:
         QAction *fileOpen = nullptr;
         QMenu *fileRecent = nullptr;
         QAction *fileCreateReport = nullptr;
+        QAction *fileCreateSystemReport = nullptr;
+        QAction *fileExportSimilarity = nullptr;
         QAction *fileSettings = nullptr;
         QAction *fileExit = nullptr;
         QAction *editEditRom = nullptr;
         QAction *editShowDuplicates = nullptr;
+        QAction *editCompare = nullptr;
         QAction *editShowInFileBrowser = nullptr;
         QAction *editCopyChecksum = nullptr;
         QAction *helpHelp = nullptr;
@@ -54,23 +62,44 @@ private:
         QTableView *browser = nullptr;
         QProgressBar *progress = nullptr;
         QLabel *progressMsg = nullptr;
+        BusyIndicator *reportProgress = nullptr;
+        QTabWidget *preview = nullptr;
+        QSpinBox *searchAddress = nullptr;
+        QSpinBox *searchRack = nullptr;
     };
     Widgets widgets_;
     QList<QPointer<EditorWindow>> editors_;
-    QFileSystemWatcher *fsWatcher_;
+    LibraryWatcher *libraryWatcher_ = nullptr;
     RomLibraryModel *browserModel_;
     RomLibrarySortFilterModel *sortFilterModel_;
+    /** Library id of the ROM requested for the preview, or 0 if nothing is previewed. */
+    qint64 previewRomId_ = 0;
+    Rom *previewRom_ = nullptr;
 
     void initMenus();
     void initWidgets();
     void initFsWatcher();
     void openFrom(const QString &path);
     void updateRecentDocuments(const QString &path = {});
-    void showEditor(Rom *rom, const QString &path = {});
+    EditorWindow *showEditor(Rom *rom, const QString &path = {});
     [[nodiscard]] const RomInfo &getSelectedRomInfo() const;
-    void watchPath(const QString &path);
+    [[nodiscard]] QStringList getSelectedRomPaths() const;
+
+    /**
+     * Load a ROM from its stored patch table, falling back to reading its file if the library doesn't have it or the
+     * file changed since it was stored.
+     *
+     * @return A future finishing on the GUI thread. Throws InvalidRomException if the file must be read and is not a
+     * ROM.
+     */
+    [[nodiscard]] QFuture<Rom *> loadLibraryRom(const RomInfo &romInfo);
     void hideProgressIfComplete();
 
+    /**
+     * Create reports for every ROM in @p romPaths in a directory chosen by the user.
+     */
+    void createReports(const QStringList &romPaths);
+
 protected Q_SLOTS:
     void closeEvent(QCloseEvent *event) override;
 
@@ -78,17 +107,26 @@ private Q_SLOTS:
     void newFile(Rom::Type romType);
     void open();
     void createReport();
+    void createSystemReport();
+    void exportSimilarity();
     void settings();
     void editRom();
     void showInFileBrowser();
     void showDuplicates();
+    void compareRom();
     void copyChecksum();
     void help();
     void about();
     void homepage();
     void updateActionsFromSelection();
+    void updatePreview();
+    void searchChanged();
     void editorClosed();
-    void directoryChanged(const QString &path);
+
+    /**
+     * Offer to recover edits from sessions that ended without saving.
+     */
+    void recoverEdits();
     void progressRangeChanged(int min, int max);
     void progressValueChanged(int value);
 };
@@ -0,0 +1,44 @@
+/**
+ * @file BusyIndicator.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#include "BusyIndicator.h"
+#include <QFutureWatcher>
+#include <QHBoxLayout>
+
+namespace patchman
+{
+
+BusyIndicator::BusyIndicator(const QString &text, QWidget *parent)
+    : QWidget(parent), label_(new QLabel(text, this)), progress_(new QProgressBar(this))
+{
+    auto *layout = new QHBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(label_);
+    // No range shows a busy animation.
+    progress_->setRange(0, 0);
+    progress_->setMaximumWidth(100);
+    layout->addWidget(progress_);
+    hide();
+}
+
+void BusyIndicator::track(const QFuture<void> &future)
+{
+    ++running_;
+    show();
+    auto *watcher = new QFutureWatcher<void>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher]()
+    {
+        watcher->deleteLater();
+        if (--running_ == 0) {
+            hide();
+        }
+    });
+    watcher->setFuture(future);
+}
+
+} // patchman
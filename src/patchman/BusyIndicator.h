@@ -0,0 +1,44 @@
+/**
+ * @file BusyIndicator.h
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#ifndef BUSYINDICATOR_H
+#define BUSYINDICATOR_H
+
+#include <QFuture>
+#include <QLabel>
+#include <QProgressBar>
+#include <QWidget>
+
+namespace patchman
+{
+
+/**
+ * Status bar widget shown while background tasks are running.
+ */
+class BusyIndicator: public QWidget
+{
+Q_OBJECT
+public:
+    explicit BusyIndicator(const QString &text, QWidget *parent = nullptr);
+
+    /**
+     * Show the indicator until @p future finishes.
+     *
+     * @param future
+     */
+    void track(const QFuture<void> &future);
+
+private:
+    QLabel *label_;
+    QProgressBar *progress_;
+    unsigned int running_ = 0;
+};
+
+} // patchman
+
+#endif //BUSYINDICATOR_H
@@ -11,6 +11,7 @@
 #include "patchlib/Exceptions.h"
 #include "util.h"
 #include "ReportBuilder.h"
+#include "LugEditCommand.h"
 #include "AboutDialog.h"
 #include "patchman_config.h"
 #include "help.h"
@@ -28,7 +29,7 @@ namespace patchman
 {
 
 EditorWindow::EditorWindow(Rom *rom, const QString &path, QWidget *parent)
-    : QMainWindow(parent), rom_(rom)
+    : QMainWindow(parent), undoStack_(new QUndoStack(this)), rom_(rom), statusTimer_(new QTimer(this))
 {
     setAttribute(Qt::WA_DeleteOnClose);
 
@@ -36,6 +37,13 @@ EditorWindow::EditorWindow(Rom *rom, const QString &path, QWidget *parent)
     rom_->setParent(this);
     initMenus();
     initWidgets();
+    journal_ = EditJournal::create(rom_, path, this);
+}
+
+void EditorWindow::markRecovered()
+{
+    // The stack can't become clean again until the ROM is saved.
+    undoStack_->resetClean();
 }
 
 void EditorWindow::initMenus()
@@ -66,6 +74,19 @@ void EditorWindow::initMenus()
     connect(actions_.fileClose, &QAction::triggered, this, &EditorWindow::close);
     menuFile->addAction(actions_.fileClose);
 
+    // Edit menu
+    QMenu *menuEdit = menuBar()->addMenu(tr("&Edit"));
+    // Undo
+    actions_.editUndo = undoStack_->createUndoAction(this, tr("&Undo"));
+    actions_.editUndo->setIcon(qiconFromTheme(ThemeIcon::EditUndo));
+    actions_.editUndo->setShortcut(QKeySequence::StandardKey::Undo);
+    menuEdit->addAction(actions_.editUndo);
+    // Redo
+    actions_.editRedo = undoStack_->createRedoAction(this, tr("&Redo"));
+    actions_.editRedo->setIcon(qiconFromTheme(ThemeIcon::EditRedo));
+    actions_.editRedo->setShortcut(QKeySequence::StandardKey::Redo);
+    menuEdit->addAction(actions_.editRedo);
+
     // Help menu
     QMenu *menuHelp = menuBar()->addMenu(tr("&Help"));
     // Help
@@ -105,13 +126,25 @@ void EditorWindow::initWidgets()
     widgets.checksum = new QLabel(this);
     statusBar()->addPermanentWidget(widgets.checksum);
 
+    widgets.reportProgress = new BusyIndicator(tr("Creating report..."), this);
+    statusBar()->addPermanentWidget(widgets.reportProgress);
+
+    // Computing the checksum serializes the whole ROM; do it once after all pending edits instead of after each one.
+    statusTimer_->setSingleShot(true);
+    statusTimer_->setInterval(0);
+    connect(statusTimer_, &QTimer::timeout, this, &EditorWindow::updateStatus);
+
     editor_ = new RomEditor(rom_, this);
     connect(editor_, &RomEditor::dataChanged, this, &EditorWindow::dataChanged);
     connect(rom_, &Rom::titleChanged, this, &EditorWindow::romTitleChanged);
+    for (auto *rack : rom_->getRacksView()) {
+        trackEdits(rack);
+    }
+    connect(rom_, &Rom::rackAdded, this, &EditorWindow::trackEdits);
+    connect(undoStack_, &QUndoStack::cleanChanged, this, &EditorWindow::cleanChanged);
     setCentralWidget(editor_);
     romTitleChanged();
-    updatePatchedRacksCount();
-    updateChecksum();
+    updateStatus();
 }
 
 void EditorWindow::saveTo(const QString &path)
@@ -122,7 +155,10 @@ void EditorWindow::saveTo(const QString &path)
 
     try {
         rom_->saveToFile(path);
-        setWindowModified(false);
+        undoStack_->setClean();
+        if (journal_ != nullptr) {
+            journal_->reset(path);
+        }
         setWindowFilePath(path);
     }
     catch (const UnrepresentableException &e) {
@@ -188,12 +224,23 @@ void EditorWindow::updateChecksum()
     }
 }
 
+void EditorWindow::trackEdits(Rack *rack)
+{
+    connect(rack, &Rack::lugsEdited, this, [this, rack](const QList<Rack::LugDelta> &deltas)
+    {
+        undoStack_->push(new LugEditCommand(rack, deltas));
+    });
+}
+
 void EditorWindow::closeEvent(QCloseEvent *event)
 {
     if (!maybeSave()) {
         event->ignore();
         return;
     }
+    if (journal_ != nullptr) {
+        journal_->discard();
+    }
     Settings::Sync();
     QWidget::closeEvent(event);
 }
@@ -238,9 +285,17 @@ void EditorWindow::createReport()
         return;
     }
 
-    ReportBuilder *builder = ReportBuilder::create(rom_, this);
-    const auto reportPath = builder->createReport();
-    QDesktopServices::openUrl(QUrl(QString("file:///%1").arg(reportPath), QUrl::TolerantMode));
+    auto future = ReportBuilder::createReportInBackground(rom_->getSnapshot());
+    widgets.reportProgress->track(future);
+    future
+        .then(this, [](const QString &reportPath)
+        {
+            QDesktopServices::openUrl(QUrl(QString("file:///%1").arg(reportPath), QUrl::TolerantMode));
+        })
+        .onFailed(this, [this](const std::exception &e)
+        {
+            QMessageBox::critical(this, tr("Report could not be created."), QString::fromStdString(e.what()));
+        });
 }
 
 void EditorWindow::help()
@@ -261,9 +316,10 @@ void EditorWindow::homepage()
 
 void EditorWindow::dataChanged()
 {
-    setWindowModified(true);
-    updatePatchedRacksCount();
-    updateChecksum();
+    setWindowModified(!undoStack_->isClean());
+    if (!statusTimer_->isActive()) {
+        statusTimer_->start();
+    }
 }
 
 void EditorWindow::romTitleChanged()
@@ -271,4 +327,22 @@ void EditorWindow::romTitleChanged()
     widgets.romTitle->setText(rom_->getTitle());
 }
 
+void EditorWindow::updateStatus()
+{
+    if (rom_ != nullptr) {
+        const auto editVersion = rom_->getEditVersion();
+        if (editVersion == statusEditVersion_) {
+            return;
+        }
+        statusEditVersion_ = editVersion;
+    }
+    updatePatchedRacksCount();
+    updateChecksum();
+}
+
+void EditorWindow::cleanChanged(bool clean)
+{
+    setWindowModified(!clean);
+}
+
 } // patchman
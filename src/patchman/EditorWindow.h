@@ -11,8 +11,12 @@
 
 #include <QMainWindow>
 #include <patchlib/Rom.h>
+#include <patchlib/EditJournal.h>
 #include <QLabel>
+#include <QTimer>
+#include <QUndoStack>
 #include "RomEditor.h"
+#include "BusyIndicator.h"
 
 namespace patchman
 {
@@ -33,14 +37,24 @@ public:
      */
     explicit EditorWindow(Rom *rom, const QString &path, QWidget *parent = nullptr);
 
+    /**
+     * Mark the ROM as having unsaved changes recovered from a previous session.
+     */
+    void markRecovered();
+
 private:
     RomEditor *editor_ = nullptr;
+    QUndoStack *undoStack_;
+    /** May be `nullptr` if the journal could not be created. */
+    EditJournal *journal_ = nullptr;
     struct Actions
     {
         QAction *fileSave = nullptr;
         QAction *fileSaveAs = nullptr;
         QAction *fileCreateReport = nullptr;
         QAction *fileClose = nullptr;
+        QAction *editUndo = nullptr;
+        QAction *editRedo = nullptr;
         QAction *helpHelp = nullptr;
         QAction *helpAbout = nullptr;
         QAction *helpHomepage = nullptr;
@@ -52,9 +66,14 @@ private:
         QLabel *romTitle = nullptr;
         QLabel *patchedRacksCount = nullptr;
         QLabel *checksum = nullptr;
+        BusyIndicator *reportProgress = nullptr;
     };
     Widgets widgets;
     Rom *rom_ = nullptr;
+    /** Coalesces status bar updates from bursts of edits. */
+    QTimer *statusTimer_;
+    /** Rom::getEditVersion() the status bar was last updated for. */
+    quint64 statusEditVersion_ = 0;
 
     void initMenus();
     void initWidgets();
@@ -65,6 +84,11 @@ private:
     void updatePatchedRacksCount();
     void updateChecksum();
 
+    /**
+     * Record edits to @p rack on the undo stack.
+     */
+    void trackEdits(Rack *rack);
+
 protected Q_SLOTS:
     void closeEvent(QCloseEvent *event) override;
 
@@ -77,6 +101,8 @@ private Q_SLOTS:
     void homepage();
     void dataChanged();
     void romTitleChanged();
+    void updateStatus();
+    void cleanChanged(bool clean);
 };
 
 } // patchman
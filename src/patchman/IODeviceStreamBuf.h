@@ -0,0 +1,100 @@
+/**
+ * @file IODeviceStreamBuf.h
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#ifndef IODEVICESTREAMBUF_H
+#define IODEVICESTREAMBUF_H
+
+#include <QIODevice>
+#include <array>
+#include <streambuf>
+
+namespace patchman
+{
+
+/**
+ * Buffered output stream buffer writing to a QIODevice, so a std::ostream can write to files and other devices.
+ *
+ * The device must already be open for writing. Call pubsync() (or flush the stream) before using the device
+ * elsewhere.
+ */
+class IODeviceStreamBuf: public std::streambuf
+{
+public:
+    explicit IODeviceStreamBuf(QIODevice *device)
+        : device_(device)
+    {
+        setp(buffer_.data(), buffer_.data() + buffer_.size());
+    }
+
+    ~IODeviceStreamBuf() override
+    {
+        sync();
+    }
+
+    Q_DISABLE_COPY_MOVE(IODeviceStreamBuf)
+
+protected:
+    int_type overflow(int_type ch) override
+    {
+        if (!flushBuffer()) {
+            return traits_type::eof();
+        }
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    int sync() override
+    {
+        return flushBuffer() ? 0 : -1;
+    }
+
+    std::streamsize xsputn(const char_type *s, std::streamsize count) override
+    {
+        // Large writes (like embedded stylesheets) go straight to the device instead of through the buffer.
+        if (count >= static_cast<std::streamsize>(buffer_.size())) {
+            if (!flushBuffer()) {
+                return 0;
+            }
+            return writeAll(s, count);
+        }
+        return std::streambuf::xsputn(s, count);
+    }
+
+private:
+    static constexpr std::size_t kBufferSize = 64 * 1024;
+    QIODevice *device_;
+    std::array<char, kBufferSize> buffer_;
+
+    bool flushBuffer()
+    {
+        const auto pending = pptr() - pbase();
+        const auto written = writeAll(pbase(), pending);
+        setp(buffer_.data(), buffer_.data() + buffer_.size());
+        return written == pending;
+    }
+
+    std::streamsize writeAll(const char *data, std::streamsize count)
+    {
+        std::streamsize pos = 0;
+        while (pos < count) {
+            const auto bytesWritten = device_->write(data + pos, count - pos);
+            if (bytesWritten <= 0) {
+                break;
+            }
+            pos += bytesWritten;
+        }
+        return pos;
+    }
+};
+
+} // patchman
+
+#endif //IODEVICESTREAMBUF_H
@@ -0,0 +1,63 @@
+/**
+ * @file LugEditCommand.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#include "LugEditCommand.h"
+#include <algorithm>
+
+namespace patchman
+{
+
+LugEditCommand::LugEditCommand(Rack *rack, const QList<Rack::LugDelta> &deltas, QUndoCommand *parent)
+    : QUndoCommand(parent), rack_(rack), deltas_(deltas)
+{
+    setText(deltas_.size() == 1
+            ? tr("Edit %1 Circuit %2").arg(rack_->getRackName()).arg(rack_->getCircuitForLug(deltas_.front().lug) + 1)
+            : tr("Edit %1").arg(rack_->getRackName()));
+}
+
+void LugEditCommand::undo()
+{
+    rack_->applyLugDeltas(deltas_, true);
+    applied_ = false;
+}
+
+void LugEditCommand::redo()
+{
+    // Pushing the command to the stack calls this; the edit has already been made.
+    if (applied_) {
+        return;
+    }
+    rack_->applyLugDeltas(deltas_);
+    applied_ = true;
+}
+
+int LugEditCommand::id() const
+{
+    return kId;
+}
+
+bool LugEditCommand::mergeWith(const QUndoCommand *other)
+{
+    const auto *otherEdit = static_cast<const LugEditCommand *>(other);
+    const auto sameLugs = std::ranges::equal(deltas_, otherEdit->deltas_, {}, &Rack::LugDelta::lug, &Rack::LugDelta::lug);
+    if (otherEdit->rack_ != rack_ || !sameLugs) {
+        return false;
+    }
+
+    for (qsizetype ix = 0; ix < deltas_.size(); ++ix) {
+        deltas_[ix].after = otherEdit->deltas_[ix].after;
+    }
+    // Edited back to where it started.
+    setObsolete(std::ranges::all_of(deltas_, [](const Rack::LugDelta &delta)
+    {
+        return delta.before == delta.after;
+    }));
+    return true;
+}
+
+} // patchman
@@ -0,0 +1,50 @@
+/**
+ * @file LugEditCommand.h
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#ifndef LUGEDITCOMMAND_H
+#define LUGEDITCOMMAND_H
+
+#include <QCoreApplication>
+#include <QUndoCommand>
+#include "patchlib/Rack.h"
+
+namespace patchman
+{
+
+/**
+ * Undo command for one edit to a rack's lugs.
+ *
+ * Only the changed lug words are stored, so even a large history costs little memory. Commands are created from
+ * Rack::lugsEdited() after the edit has been made, so the first redo() does nothing.
+ */
+class LugEditCommand: public QUndoCommand
+{
+Q_DECLARE_TR_FUNCTIONS(LugEditCommand)
+public:
+    explicit LugEditCommand(Rack *rack, const QList<Rack::LugDelta> &deltas, QUndoCommand *parent = nullptr);
+
+    void undo() override;
+    void redo() override;
+    [[nodiscard]] int id() const override;
+
+    /**
+     * Merge in a following edit to the same lugs of the same rack, e.g. repeatedly changing one address.
+     */
+    bool mergeWith(const QUndoCommand *other) override;
+
+private:
+    static constexpr int kId = 1;
+    Rack *rack_;
+    /** In lug order. */
+    QList<Rack::LugDelta> deltas_;
+    bool applied_ = true;
+};
+
+} // patchman
+
+#endif //LUGEDITCOMMAND_H
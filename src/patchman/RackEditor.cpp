@@ -12,6 +12,7 @@
 #include "enr/EnrRackEditor.h"
 #include <QPushButton>
 #include <QVBoxLayout>
+#include <vector>
 
 namespace patchman {
 
@@ -88,14 +89,16 @@ void RackEditorContainer::autonumber()
         return;
     }
     const auto options = dialog.getOptions();
+    std::vector<Rack::LugEdit> edits;
+    edits.reserve(circuits.size());
     unsigned int nextAddress = options.start;
     for (auto circuitIt = circuits.begin(); circuitIt != circuits.end();
          circuitIt += options.offset) {
         const auto circuit = *circuitIt;
-        const auto lug = rack_->getLugForCircuit(circuit);
-        rack_->setLugAddress(lug, nextAddress);
+        edits.push_back({.lug = rack_->getLugForCircuit(circuit), .address = nextAddress});
         nextAddress += options.increment;
     }
+    rack_->setLugAddresses(edits);
 }
 
 void RackEditorContainer::unpatch()
@@ -105,10 +108,12 @@ void RackEditorContainer::unpatch()
         circuits.resize(rack_->getLugCount());
         std::iota(circuits.begin(), circuits.end(), 0);
     }
+    std::vector<Rack::LugEdit> edits;
+    edits.reserve(circuits.size());
     for (const auto circuit : circuits) {
-        const auto lug = rack_->getLugForCircuit(circuit);
-        rack_->setLugAddress(lug, 0);
+        edits.push_back({.lug = rack_->getLugForCircuit(circuit), .address = 0});
     }
+    rack_->setLugAddresses(edits);
 }
 
 void RackEditorContainer::tableSelectionChanged()
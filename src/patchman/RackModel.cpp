@@ -8,6 +8,7 @@
 
 #include <QColor>
 #include "RackModel.h"
+#include <algorithm>
 
 namespace patchman
 {
@@ -18,12 +19,13 @@ RackModel::RackModel(Rack *rack, QObject *parent)
     updateLugCount();
     connect(rack_, &Rack::rackTypeChanged, this, &RackModel::rackTypeChanged);
     connect(rack_, &Rack::lugChanged, this, &RackModel::lugChanged);
+    connect(rack_, &Rack::lugRangeChanged, this, &RackModel::lugRangeChanged);
 }
 
 void RackModel::updateLugCount()
 {
     beginResetModel();
-    lugCount_ = static_cast<int>(std::size(rack_->getLugAddressesView()));
+    lugCount_ = static_cast<int>(rack_->getLugCount());
     endResetModel();
 }
 
@@ -164,4 +166,20 @@ void RackModel::lugChanged(unsigned int lug)
     ));
 }
 
+void RackModel::lugRangeChanged(unsigned int firstLug, unsigned int lastLug)
+{
+    // Circuits are not numbered in lug order, so find the rows the lugs cover.
+    unsigned int firstCircuit = rack_->getCircuitForLug(firstLug);
+    unsigned int lastCircuit = firstCircuit;
+    for (auto lug = firstLug + 1; lug <= lastLug; ++lug) {
+        const auto circuit = rack_->getCircuitForLug(lug);
+        firstCircuit = std::min(firstCircuit, circuit);
+        lastCircuit = std::max(lastCircuit, circuit);
+    }
+    Q_EMIT(dataChanged(
+        createIndex(static_cast<int>(firstCircuit), 0),
+        createIndex(static_cast<int>(lastCircuit), columnCount(QModelIndex()) - 1)
+    ));
+}
+
 } // patchman
@@ -52,6 +52,7 @@ private:
 private Q_SLOTS:
     void rackTypeChanged();
     void lugChanged(unsigned int lug);
+    void lugRangeChanged(unsigned int firstLug, unsigned int lastLug);
 };
 
 } // patchman
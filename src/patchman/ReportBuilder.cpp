@@ -7,12 +7,17 @@
  */
 
 #include "ReportBuilder.h"
+#include "IODeviceStreamBuf.h"
+#include "ReportData.h"
+#include "ReportTemplateCache.h"
 #include "d192/D192ReportBuilder.h"
 #include "enr/EnrReportBuilder.h"
+#include <QtConcurrent>
 #include <QFile>
 #include <QTemporaryFile>
 #include <QDebug>
 #include <QDir>
+#include <memory>
 
 namespace patchman
 {
@@ -26,6 +31,21 @@ ReportBuilder *ReportBuilder::create(const Rom *rom, QObject *parent)
     Q_UNREACHABLE();
 }
 
+QString ReportBuilder::createReportFile(const Rom *rom)
+{
+    const std::unique_ptr<ReportBuilder> builder(create(rom));
+    return builder->createReport();
+}
+
+QFuture<QString> ReportBuilder::createReportInBackground(const RomSnapshot &snapshot)
+{
+    return QtConcurrent::run([snapshot]()
+    {
+        const std::unique_ptr<Rom> rom(snapshot.toRom());
+        return createReportFile(rom.get());
+    });
+}
+
 ReportBuilder::ReportBuilder(QObject *parent)
     : QObject(parent)
 {
@@ -41,13 +61,7 @@ ReportBuilder::ReportBuilder(QObject *parent)
     inja_.add_callback("embed", 1, [](inja::Arguments &args)
     {
         const auto embedPath = args.at(0)->get<std::string>();
-        QFile embedFile(QString(":/reports/%1").arg(QString::fromStdString(embedPath)));
-        if (!embedFile.open(QFile::ReadOnly | QFile::Text)) {
-            throw inja::FileError("Cannot load embedded resource " + embedPath);
-        }
-        const auto embedData = embedFile.readAll();
-        const std::string embedString(embedData.data(), embedData.size());
-        return embedString;
+        return ReportTemplateCache::get().getAsset(QString::fromStdString(embedPath));
     });
 
     // Batch lists
@@ -97,71 +111,48 @@ ReportBuilder::ReportBuilder(QObject *parent)
 
 QString ReportBuilder::createReport()
 {
-    const auto report = render();
-
     QTemporaryFile reportFile(QDir::temp().filePath("patchreport-XXXXXX.html"), this);
     reportFile.setAutoRemove(false);
     reportFile.open();
     qInfo() << "Writing report to" << reportFile.fileName();
-    std::size_t pos = 0;
-    do {
-        const auto bytesWritten = reportFile.write(report.data() + pos, report.size() - pos);
-        if (bytesWritten == -1) {
-            break;
-        }
-        pos += bytesWritten;
+    if (!createReport(&reportFile)) {
+        qWarning() << "Error writing report:" << reportFile.errorString();
     }
-    while (pos != report.size());
-    reportFile.flush();
 
     return reportFile.fileName();
 }
 
+bool ReportBuilder::createReport(QIODevice *device)
+{
+    IODeviceStreamBuf streamBuf(device);
+    std::ostream out(&streamBuf);
+    render(out);
+    out.flush();
+    return out.good();
+}
+
 inja::Template ReportBuilder::loadTemplate(const QString &path)
 {
+    auto &cache = ReportTemplateCache::get();
+    if (auto cached = cache.findTemplate(path)) {
+        // The templates this one includes were cached when it was parsed, but this environment hasn't seen them.
+        cache.includeAll(inja_);
+        return std::move(*cached);
+    }
+
     QFile templateFile(QString(":/reports/%1").arg(path));
     if (!templateFile.open(QFile::ReadOnly | QFile::Text)) {
         throw inja::FileError("Cannot load template " + path.toStdString());
     }
     const auto templateData = templateFile.readAll();
-    return inja_.parse(std::string_view(templateData.data(), templateData.size()));
+    auto parsed = inja_.parse(std::string_view(templateData.data(), templateData.size()));
+    cache.insertTemplate(path, parsed);
+    return parsed;
 }
 
 inja::json ReportBuilder::buildAddressTableData(const Rom *rom)
 {
-    inja::json data;
-
-    for (const auto *rack : rom->getRacksView()) {
-        // Skip unpatched racks.
-        if (!rack->isPatched()) {
-            continue;
-        }
-
-        std::vector<inja::json> circuits;
-        for (const auto [lug, address] : rack->getLugAddressesView()) {
-            auto &cktInfo = circuits.emplace_back();
-            cktInfo["phase"] = rack->getPhaseForLug(lug);
-            cktInfo["lug"] = lug + 1;
-            cktInfo["circuit"] = rack->getCircuitForLug(lug) + 1;
-            cktInfo["module"] = rack->getModuleNameForLug(lug).toStdString();
-            cktInfo["address"] = address;
-        }
-        std::vector<inja::json> lugs = circuits;
-        std::sort(lugs.begin(), lugs.end(), [](const inja::json &a, const inja::json &b)
-        {
-            return a["lug"].get<unsigned int>() < b["lug"].get<unsigned int>();
-        });
-        std::sort(circuits.begin(), circuits.end(), [](const inja::json &a, const inja::json &b)
-        {
-            return a["circuit"].get<unsigned int>() < b["circuit"].get<unsigned int>();
-        });
-
-        data["racks"][rack->getRackNum()]["num"] = rack->getRackNum();
-        data["racks"][rack->getRackNum()]["circuits"] = circuits;
-        data["racks"][rack->getRackNum()]["lugs"] = lugs;
-    }
-
-    return data;
+    return ReportData::create(rom).toJson();
 }
 
 } // patchman
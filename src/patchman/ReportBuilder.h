@@ -10,6 +10,9 @@
 #define REPORTBUILDER_H
 
 #include <QObject>
+#include <QFuture>
+#include <QIODevice>
+#include <ostream>
 #include "patchlib/Rom.h"
 #include <inja/inja.hpp>
 
@@ -26,20 +29,42 @@ public:
     static ReportBuilder *create(const Rom *rom, QObject *parent = nullptr);
 
     /**
-     * Create the report.
+     * Create a report for @p rom in a temporary file.
+     * @return Path to generated report file.
+     */
+    static QString createReportFile(const Rom *rom);
+
+    /**
+     * Create a report for @p snapshot in a temporary file on a worker thread.
+     *
+     * The ROM the snapshot came from may be edited while the report renders.
+     * @return Path to generated report file.
+     */
+    static QFuture<QString> createReportInBackground(const RomSnapshot &snapshot);
+
+    /**
+     * Create the report in a temporary file.
      * @return Path to generated report file.
      */
     QString createReport();
 
+    /**
+     * Create the report, writing it to @p device as it is rendered.
+     *
+     * @param device Must be open for writing.
+     * @return TRUE if the whole report was written.
+     */
+    bool createReport(QIODevice *device);
+
 protected:
     inja::Environment inja_;
 
     explicit ReportBuilder(QObject *parent = nullptr);
 
     /**
-     * Render the report template.
+     * Render the report template to @p out.
      */
-    virtual std::string render() = 0;
+    virtual void render(std::ostream &out) = 0;
 
     inja::Template loadTemplate(const QString &path);
     inja::json buildAddressTableData(const Rom *rom);
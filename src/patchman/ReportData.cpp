@@ -0,0 +1,186 @@
+/**
+ * @file ReportData.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#include "ReportData.h"
+#include "patchlib/RackDescriptor.h"
+#include <algorithm>
+
+namespace patchman
+{
+
+namespace
+{
+
+inja::json circuitToJson(const ReportCircuit &circuit, const std::vector<std::string> &moduleNames)
+{
+    return {
+        {"phase", static_cast<int>(circuit.phase)},
+        {"lug", circuit.lug + 1},
+        {"circuit", circuit.circuit + 1},
+        {"module", moduleNames.at(circuit.moduleDensity)},
+        {"address", circuit.address},
+    };
+}
+
+} // namespace
+
+inja::json RackReportData::toJson() const
+{
+    std::vector<inja::json> lugsJson;
+    lugsJson.reserve(lugs.size());
+    for (const auto &lug : lugs) {
+        lugsJson.push_back(circuitToJson(lug, moduleNames));
+    }
+    std::vector<inja::json> circuitsJson;
+    circuitsJson.reserve(circuitOrder.size());
+    for (const auto lugIx : circuitOrder) {
+        circuitsJson.push_back(lugsJson[lugIx]);
+    }
+
+    return {
+        {"num", num},
+        {"circuits", std::move(circuitsJson)},
+        {"lugs", std::move(lugsJson)},
+    };
+}
+
+ReportData ReportData::create(const Rom *rom)
+{
+    ReportData data;
+    for (const auto *rack : rom->getRacksView()) {
+        // Skip unpatched racks.
+        if (!rack->isPatched()) {
+            continue;
+        }
+
+        auto &rackData = data.racks.emplace_back();
+        rackData.num = rack->getRackNum();
+        visitRackType(rack->getRackType(), [rack, &rackData](auto traits)
+        {
+            constexpr const auto &descriptor = decltype(traits)::kDescriptor;
+            const auto lugWords = rack->getLugWords();
+            Q_ASSERT(lugWords.size() == descriptor.lugCount);
+
+            rackData.lugs.reserve(descriptor.lugCount);
+            rackData.circuitOrder.resize(descriptor.lugCount);
+            for (unsigned int lug = 0; lug < descriptor.lugCount; ++lug) {
+                const auto circuit = descriptor.getCircuitForLug(lug);
+                rackData.lugs.push_back({
+                    .phase = descriptor.getPhaseForLug(lug),
+                    .lug = lug,
+                    .circuit = circuit,
+                    .moduleDensity = descriptor.getModuleDensityForLug(lugWords, lug),
+                    .address = static_cast<unsigned int>(lugWords[lug] & Rack::kLugWordAddressMask),
+                });
+                // Circuits are a permutation of lugs, so no sort is needed.
+                rackData.circuitOrder[circuit] = lug;
+            }
+
+            rackData.moduleNames.reserve(descriptor.lugsPerModule + 1);
+            for (unsigned int density = 0; density <= descriptor.lugsPerModule; ++density) {
+                rackData.moduleNames.push_back(descriptor.getModuleName(density).toStdString());
+            }
+        });
+    }
+
+    return data;
+}
+
+inja::json ReportData::toJson() const
+{
+    std::vector<inja::json> racksJson;
+    racksJson.reserve(racks.size());
+    for (const auto &rack : racks) {
+        racksJson.push_back(rack.toJson());
+    }
+
+    return {{"racks", std::move(racksJson)}};
+}
+
+SystemReportData SystemReportData::create(const QList<std::pair<QString, const Rom *>> &roms)
+{
+    SystemReportData data;
+    data.roms.reserve(roms.size());
+    data.addresses.resize(Rack::kLugWordAddressMask + 1);
+    for (const auto &[name, rom] : roms) {
+        const auto romIx = static_cast<unsigned int>(data.roms.size());
+        auto &romData = data.roms.emplace_back(RomData{
+            .name = name.toStdString(),
+            .typeName = Rom::typeName(rom->getType()).toStdString(),
+            .report = ReportData::create(rom),
+        });
+        // Circuit order keeps each address's patches in the order they appear in the address tables.
+        for (const auto &rack : romData.report.racks) {
+            for (const auto lugIx : rack.circuitOrder) {
+                const auto &circuit = rack.lugs[lugIx];
+                if (circuit.address != 0) {
+                    data.addresses[circuit.address].push_back({romIx, rack.num, circuit.circuit});
+                }
+            }
+        }
+    }
+
+    return data;
+}
+
+bool SystemReportData::isCollision(unsigned int address) const
+{
+    const auto &patches = addresses.at(address);
+    return std::ranges::any_of(patches, [&patches](const SystemReportPatch &patch)
+    {
+        return patch.rom != patches.front().rom;
+    });
+}
+
+inja::json SystemReportData::toJson() const
+{
+    std::vector<inja::json> romsJson;
+    romsJson.reserve(roms.size());
+    for (const auto &rom : roms) {
+        auto romJson = rom.report.toJson();
+        romJson["name"] = rom.name;
+        romJson["type"] = rom.typeName;
+        romsJson.push_back(std::move(romJson));
+    }
+
+    std::vector<inja::json> addressesJson;
+    std::vector<inja::json> collisionsJson;
+    for (unsigned int address = 1; address < addresses.size(); ++address) {
+        const auto &patches = addresses[address];
+        if (patches.empty()) {
+            continue;
+        }
+        std::vector<inja::json> patchesJson;
+        patchesJson.reserve(patches.size());
+        for (const auto &patch : patches) {
+            patchesJson.push_back({
+                {"rom", roms[patch.rom].name},
+                {"rack", patch.rack},
+                {"circuit", patch.circuit + 1},
+            });
+        }
+        const auto collision = isCollision(address);
+        inja::json addressJson{
+            {"address", address},
+            {"collision", collision},
+            {"patches", std::move(patchesJson)},
+        };
+        if (collision) {
+            collisionsJson.push_back(addressJson);
+        }
+        addressesJson.push_back(std::move(addressJson));
+    }
+
+    return {
+        {"roms", std::move(romsJson)},
+        {"addresses", std::move(addressesJson)},
+        {"collisions", std::move(collisionsJson)},
+    };
+}
+
+} // patchman
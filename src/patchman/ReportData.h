@@ -0,0 +1,114 @@
+/**
+ * @file ReportData.h
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#ifndef REPORTDATA_H
+#define REPORTDATA_H
+
+#include <string>
+#include <utility>
+#include <vector>
+#include <inja/inja.hpp>
+#include "patchlib/Rom.h"
+
+namespace patchman
+{
+
+/**
+ * One lug as shown in a report.
+ */
+struct ReportCircuit
+{
+    Phase phase;
+    unsigned int lug;
+    unsigned int circuit;
+    /** Number of patched lugs in this lug's module; index into RackReportData::moduleNames. */
+    unsigned int moduleDensity;
+    unsigned int address;
+};
+
+/**
+ * One rack as shown in a report.
+ */
+struct RackReportData
+{
+    unsigned int num;
+    /** Every lug in the rack, in lug order. */
+    std::vector<ReportCircuit> lugs;
+    /** Indexes into lugs, in circuit order. */
+    std::vector<unsigned int> circuitOrder;
+    /** Module names by density. */
+    std::vector<std::string> moduleNames;
+
+    [[nodiscard]] inja::json toJson() const;
+};
+
+/**
+ * Everything shown in a ROM's address table report.
+ */
+struct ReportData
+{
+    /** Patched racks, in rack order. */
+    std::vector<RackReportData> racks;
+
+    static ReportData create(const Rom *rom);
+
+    /**
+     * Convert to the structure used by the report templates.
+     */
+    [[nodiscard]] inja::json toJson() const;
+};
+
+/**
+ * One place a DMX address is patched in a system report.
+ */
+struct SystemReportPatch
+{
+    /** Index into SystemReportData::roms. */
+    unsigned int rom;
+    unsigned int rack;
+    unsigned int circuit;
+};
+
+/**
+ * Everything shown in a report combining several ROMs.
+ */
+struct SystemReportData
+{
+    struct RomData
+    {
+        std::string name;
+        std::string typeName;
+        ReportData report;
+    };
+
+    std::vector<RomData> roms;
+    /** Where each DMX address is patched, indexed by address. */
+    std::vector<std::vector<SystemReportPatch>> addresses;
+
+    /**
+     * @param roms Pairs of ROM names and ROMs.
+     */
+    static SystemReportData create(const QList<std::pair<QString, const Rom *>> &roms);
+
+    /**
+     * Is @p address patched in more than one ROM?
+     *
+     * Patching an address to several circuits in one ROM is normal, but across ROMs it means two racks respond to
+     * the same address.
+     */
+    [[nodiscard]] bool isCollision(unsigned int address) const;
+
+    /**
+     * Convert to the structure used by the report templates.
+     */
+    [[nodiscard]] inja::json toJson() const;
+};
+
+} // patchman
+
+#endif //REPORTDATA_H
@@ -0,0 +1,72 @@
+/**
+ * @file ReportTemplateCache.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#include "ReportTemplateCache.h"
+#include <QFile>
+#include <mutex>
+
+namespace patchman
+{
+
+ReportTemplateCache &ReportTemplateCache::get()
+{
+    static ReportTemplateCache instance;
+    return instance;
+}
+
+std::optional<inja::Template> ReportTemplateCache::findTemplate(const QString &path) const
+{
+    std::shared_lock templatesGuard(mutex_);
+    const auto it = templates_.constFind(path);
+    if (it == templates_.cend()) {
+        return {};
+    }
+    return *it;
+}
+
+void ReportTemplateCache::insertTemplate(const QString &path, const inja::Template &parsed)
+{
+    std::scoped_lock templatesGuard(mutex_);
+    if (!templates_.contains(path)) {
+        templates_.insert(path, parsed);
+    }
+}
+
+void ReportTemplateCache::includeAll(inja::Environment &environment) const
+{
+    std::shared_lock templatesGuard(mutex_);
+    for (auto it = templates_.cbegin(); it != templates_.cend(); ++it) {
+        environment.include_template(it.key().toStdString(), it.value());
+    }
+}
+
+std::string ReportTemplateCache::getAsset(const QString &path)
+{
+    {
+        std::shared_lock assetsGuard(mutex_);
+        const auto it = assets_.constFind(path);
+        if (it != assets_.cend()) {
+            return *it;
+        }
+    }
+
+    QFile assetFile(QString(":/reports/%1").arg(path));
+    if (!assetFile.open(QFile::ReadOnly | QFile::Text)) {
+        throw inja::FileError("Cannot load embedded resource " + path.toStdString());
+    }
+    const auto assetData = assetFile.readAll();
+    std::string asset(assetData.data(), assetData.size());
+
+    std::scoped_lock assetsGuard(mutex_);
+    if (!assets_.contains(path)) {
+        assets_.insert(path, asset);
+    }
+    return asset;
+}
+
+} // patchman
@@ -0,0 +1,76 @@
+/**
+ * @file ReportTemplateCache.h
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#ifndef REPORTTEMPLATECACHE_H
+#define REPORTTEMPLATECACHE_H
+
+#include <QHash>
+#include <QString>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <inja/inja.hpp>
+
+namespace patchman
+{
+
+/**
+ * Process-wide cache of parsed report templates and the assets they embed.
+ *
+ * Templates are parsed once no matter how many reports are generated. This class is thread-safe.
+ */
+class ReportTemplateCache
+{
+public:
+    static ReportTemplateCache &get();
+
+    /**
+     * Get the parsed template for the resource at @p path, if it has been cached.
+     *
+     * @param path Path relative to the report resources.
+     */
+    [[nodiscard]] std::optional<inja::Template> findTemplate(const QString &path) const;
+
+    /**
+     * Cache the parsed template for @p path. Does nothing if it is already cached.
+     *
+     * @param path Path relative to the report resources.
+     * @param parsed
+     */
+    void insertTemplate(const QString &path, const inja::Template &parsed);
+
+    /**
+     * Make every cached template available for inclusion in @p environment.
+     *
+     * A cached template is rendered without parsing it again, so the environment never sees the templates it
+     * includes or extends.
+     *
+     * @param environment
+     */
+    void includeAll(inja::Environment &environment) const;
+
+    /**
+     * Get the contents of the resource at @p path, reading it the first time.
+     *
+     * @param path Path relative to the report resources.
+     * @throw inja::FileError if the resource does not exist.
+     */
+    [[nodiscard]] std::string getAsset(const QString &path);
+
+private:
+    mutable std::shared_mutex mutex_;
+    QHash<QString, inja::Template> templates_;
+    QHash<QString, std::string> assets_;
+
+    explicit ReportTemplateCache() = default;
+    Q_DISABLE_COPY_MOVE(ReportTemplateCache)
+};
+
+} // patchman
+
+#endif //REPORTTEMPLATECACHE_H
@@ -0,0 +1,83 @@
+/**
+ * @file RomDiffDialog.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#include <QVBoxLayout>
+#include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QLabel>
+#include "RomDiffDialog.h"
+
+namespace patchman
+{
+
+RomDiffDialog::RomDiffDialog(const Rom &source,
+                             const QString &sourceName,
+                             const Rom &modified,
+                             const QString &modifiedName,
+                             QWidget *parent)
+    : QDialog(parent)
+{
+    const auto diff = RomDiff::compare(source, modified);
+
+    resize(600, 480);
+    setWindowTitle(tr("Compare %1").arg(modifiedName));
+
+    auto *layout = new QVBoxLayout(this);
+
+    // Title
+    QString summary;
+    if (diff.isEmpty()) {
+        summary = tr("%1 is patched the same as %2.").arg(modifiedName, sourceName);
+    }
+    else {
+        summary = tr("%1 differs from %2 in %n lug(s).", "", static_cast<int>(diff.getLugDiffs().size()))
+            .arg(modifiedName, sourceName);
+    }
+    if (diff.isRomTypeChanged()) {
+        summary.append(' ');
+        summary.append(tr("The ROMs are different types."));
+    }
+    auto *summaryLabel = new QLabel(summary, this);
+    summaryLabel->setWordWrap(true);
+    layout->addWidget(summaryLabel);
+
+    // List
+    diffList_ = new QTreeWidget(this);
+    diffList_->setRootIsDecorated(false);
+    diffList_->setHeaderLabels({
+        tr("Rack"),
+        tr("Circuit"),
+        tr("Source Address"),
+        tr("Modified Address"),
+        tr("Source Analog"),
+        tr("Modified Analog"),
+    });
+    diffList_->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    bool analogChanged = false;
+    for (const auto &lugDiff : diff.getLugDiffs()) {
+        auto *item = new QTreeWidgetItem(diffList_);
+        item->setData(static_cast<int>(Column::Rack), Qt::DisplayRole, lugDiff.rack);
+        item->setData(static_cast<int>(Column::Circuit), Qt::DisplayRole, lugDiff.circuit + 1);
+        item->setData(static_cast<int>(Column::SourceAddress), Qt::DisplayRole, lugDiff.getSourceAddress());
+        item->setData(static_cast<int>(Column::ModifiedAddress), Qt::DisplayRole, lugDiff.getModifiedAddress());
+        item->setData(static_cast<int>(Column::SourceAnalog), Qt::DisplayRole, lugDiff.getSourceAnalog());
+        item->setData(static_cast<int>(Column::ModifiedAnalog), Qt::DisplayRole, lugDiff.getModifiedAnalog());
+        analogChanged = analogChanged || lugDiff.isAnalogChanged();
+    }
+    // Only ENR racks have analog channels.
+    diffList_->setColumnHidden(static_cast<int>(Column::SourceAnalog), !analogChanged);
+    diffList_->setColumnHidden(static_cast<int>(Column::ModifiedAnalog), !analogChanged);
+    layout->addWidget(diffList_);
+
+    // Buttons
+    auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &RomDiffDialog::close);
+    layout->addWidget(buttonBox);
+}
+
+} // patchman
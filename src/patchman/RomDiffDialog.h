@@ -0,0 +1,47 @@
+/**
+ * @file RomDiffDialog.h
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#ifndef ROMDIFFDIALOG_H
+#define ROMDIFFDIALOG_H
+
+#include <QDialog>
+#include <QTreeWidget>
+#include "patchlib/RomDiff.h"
+
+namespace patchman
+{
+
+/**
+ * Display the lugs patched differently in two ROMs.
+ */
+class RomDiffDialog: public QDialog
+{
+Q_OBJECT
+public:
+    explicit RomDiffDialog(const Rom &source,
+                           const QString &sourceName,
+                           const Rom &modified,
+                           const QString &modifiedName,
+                           QWidget *parent = nullptr);
+
+private:
+    enum class Column
+    {
+        Rack,
+        Circuit,
+        SourceAddress,
+        ModifiedAddress,
+        SourceAnalog,
+        ModifiedAnalog,
+    };
+    QTreeWidget *diffList_;
+};
+
+} // patchman
+
+#endif //ROMDIFFDIALOG_H
@@ -47,6 +47,7 @@ QVariant RomLibraryModel::headerData(int section, Qt::Orientation orientation, i
                 case Column::Modified:return tr("Modified");
                 case Column::RackCount:return tr("Racks");
                 case Column::Checksum:return tr("Checksum");
+                case Column::Matches:return tr("Matches");
                 case Column::PatchHash:return tr("Patch Hash");
             }
         }
@@ -76,6 +77,11 @@ QVariant RomLibraryModel::data(const QModelIndex &index, int role) const
         else if (column == Column::Checksum) {
             return romInfo.getRomChecksum().toHex();
         }
+        else if (column == Column::Matches) {
+            if (addressMatches_.has_value()) {
+                return addressMatches_->value(romInfo.getId()).join(", ");
+            }
+        }
         else if (column == Column::PatchHash) {
             return romInfo.getPatchHash().toHex();
         }
@@ -103,6 +109,11 @@ QVariant RomLibraryModel::data(const QModelIndex &index, int role) const
         else if (column == Column::Checksum) {
             return romInfo.getRomChecksum();
         }
+        else if (column == Column::Matches) {
+            if (addressMatches_.has_value()) {
+                return static_cast<int>(addressMatches_->value(romInfo.getId()).size());
+            }
+        }
         else if (column == Column::PatchHash) {
             return romInfo.getPatchHash();
         }
@@ -116,6 +127,51 @@ const RomInfo &RomLibraryModel::getRomInfoForRow(int row) const
     return romInfo_.at(row);
 }
 
+void RomLibraryModel::setAddressSearch(unsigned int address, std::optional<unsigned int> rack)
+{
+    addressSearch_ = AddressSearch{address, rack};
+    updateAddressMatches();
+}
+
+bool RomLibraryModel::matchesAddressSearch(int row) const
+{
+    if (!addressMatches_.has_value()) {
+        return true;
+    }
+    return addressMatches_->contains(romInfo_.at(row).getId());
+}
+
+void RomLibraryModel::updateAddressMatches()
+{
+    if (addressSearch_.address == 0) {
+        if (addressMatches_.has_value()) {
+            beginResetModel();
+            addressMatches_.reset();
+            endResetModel();
+        }
+        return;
+    }
+
+    const auto search = addressSearch_;
+    RomLibrary::get()->findAddress(search.address, search.rack).then(
+        this,
+        [this, search](const QList<AddressMatch> &matches)
+        {
+            if (search != addressSearch_) {
+                // A newer search is running.
+                return;
+            }
+            QHash<qint64, QStringList> matchesByRom;
+            for (const auto &match : matches) {
+                matchesByRom[match.romId].push_back(tr("Rack %1 Ckt %2").arg(match.rack).arg(match.circuit + 1));
+            }
+            beginResetModel();
+            addressMatches_ = std::move(matchesByRom);
+            endResetModel();
+        }
+    );
+}
+
 void RomLibraryModel::checkForFilesystemChanges()
 {
     Q_EMIT(progressTextChanged(tr("Searching for ROMs")));
@@ -133,32 +189,38 @@ void RomLibraryModel::checkForFilesystemChanges()
                 return romInfoList;
             })
         .then(
-            [this](const QList<RomInfo> &romInfoList)
+            [this](const QList<RomInfo> &)
             {
+                Q_EMIT(progressRangeChanged(0, 0));
+                Q_EMIT(progressTextChanged(tr("Finding duplicate ROMs")));
+                auto patchTableCounts = RomLibrary::get()->getPatchHashCounts().result();
                 std::scoped_lock patchTableCountsGuard(patchTableCountsMutex_);
                 beginResetModel();
-                patchTableCounts_.clear();
-                patchTableCounts_.reserve(romInfoList.size());
-                Q_EMIT(progressRangeChanged(0, static_cast<int>(romInfoList.size())));
-                Q_EMIT(progressTextChanged(tr("Finding duplicate ROMs")));
-                for (int ix = 0; ix < romInfoList.size(); ++ix) {
-                    const auto &romInfo = romInfoList.at(ix);
-                    const auto duplicates = RomLibrary::get()->getDuplicates(romInfo).result();
-                    patchTableCounts_[romInfo.getPatchHash()] = static_cast<unsigned int>(duplicates.size());
-                    Q_EMIT(progressValueChanged(ix + 1));
-                }
+                patchTableCounts_ = std::move(patchTableCounts);
                 endResetModel();
+                // Search results may have changed with the library.
+                QMetaObject::invokeMethod(this, &RomLibraryModel::updateAddressMatches);
+                Q_EMIT(progressRangeChanged(0, 1));
+                Q_EMIT(progressValueChanged(1));
                 Q_EMIT(progressTextChanged(""));
             }
         );
 }
 
 RomLibrarySortFilterModel::RomLibrarySortFilterModel(RomLibraryModel *sourceModel, QObject *parent)
-    : QSortFilterProxyModel(parent)
+    : QSortFilterProxyModel(parent), sourceModel_(sourceModel)
 {
     QSortFilterProxyModel::setSourceModel(sourceModel);
     setFilterRole(Qt::UserRole);
     setSortRole(Qt::UserRole);
 }
 
+bool RomLibrarySortFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    if (!sourceModel_->matchesAddressSearch(sourceRow)) {
+        return false;
+    }
+    return QSortFilterProxyModel::filterAcceptsRow(sourceRow, sourceParent);
+}
+
 } // patchman
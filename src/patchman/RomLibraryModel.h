@@ -10,6 +10,7 @@
 #define ROMLIBRARYMODEL_H
 
 #include <mutex>
+#include <optional>
 #include <QAbstractTableModel>
 #include <QSortFilterProxyModel>
 #include <QFutureWatcher>
@@ -32,6 +33,7 @@ public:
         Modified,
         RackCount,
         Checksum,
+        Matches,
         PatchHash,
     };
     static const auto kColumnCount = static_cast<std::underlying_type_t<Column>>(Column::PatchHash) + 1;
@@ -44,6 +46,24 @@ public:
     [[nodiscard]] QVariant data(const QModelIndex &index, int role) const override;
     [[nodiscard]] const RomInfo &getRomInfoForRow(int row) const;
 
+    /**
+     * Only show ROMs with a lug patched to @p address, optionally limited to one rack.
+     *
+     * @param address DMX address, or 0 to show all ROMs.
+     * @param rack
+     */
+    void setAddressSearch(unsigned int address, std::optional<unsigned int> rack = {});
+
+    [[nodiscard]] bool isAddressSearchActive() const
+    {
+        return addressMatches_.has_value();
+    }
+
+    /**
+     * Does the ROM in @p row match the address search? Always true without an address search.
+     */
+    [[nodiscard]] bool matchesAddressSearch(int row) const;
+
 Q_SIGNALS:
     void progressRangeChanged(int min, int max);
     void progressTextChanged(const QString &text);
@@ -60,6 +80,18 @@ private:
     /** How many patch tables have the same hash. */
     QHash<QByteArray, unsigned int> patchTableCounts_;
     RomInfoListWatcher *watcher_;
+    struct AddressSearch
+    {
+        unsigned int address = 0;
+        std::optional<unsigned int> rack;
+
+        bool operator==(const AddressSearch &) const = default;
+    };
+    AddressSearch addressSearch_;
+    /** Descriptions of matching circuits, by ROM id. Empty optional when there is no address search. */
+    std::optional<QHash<qint64, QStringList>> addressMatches_;
+
+    void updateAddressMatches();
 };
 
 /**
@@ -70,6 +102,12 @@ class RomLibrarySortFilterModel: public QSortFilterProxyModel
 Q_OBJECT
 public:
     explicit RomLibrarySortFilterModel(RomLibraryModel *sourceModel, QObject *parent = nullptr);
+
+protected:
+    [[nodiscard]] bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+
+private:
+    RomLibraryModel *sourceModel_;
 };
 
 } // patchman
@@ -7,6 +7,8 @@
  */
 
 #include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
 #include <QDialogButtonBox>
 #include <QPushButton>
 #include <QLabel>
@@ -34,11 +36,30 @@ ShowDuplicatesDialog::ShowDuplicatesDialog(const RomInfo &romInfo, QWidget *pare
     titleLabel->setWordWrap(true);
     setWindowTitle(tr("Duplicates of %1").arg(romInfo.getFilePath()));
 
+    // Similarity
+    auto *maxLugEditsLayout = new QHBoxLayout;
+    auto *maxLugEditsLabel = new QLabel(tr("Allow up to"), this);
+    maxLugEditsLayout->addWidget(maxLugEditsLabel);
+    maxLugEdits_ = new QSpinBox(this);
+    maxLugEdits_->setRange(0, 192);
+    maxLugEdits_->setValue(16);
+    maxLugEdits_->setSuffix(tr(" different lugs"));
+    maxLugEditsLabel->setBuddy(maxLugEdits_);
+    connect(maxLugEdits_, &QSpinBox::valueChanged, this, &ShowDuplicatesDialog::refreshDuplicates);
+    maxLugEditsLayout->addWidget(maxLugEdits_);
+    maxLugEditsLayout->addStretch();
+    layout->addLayout(maxLugEditsLayout);
+
     // List
-    fileList_ = new QListWidget(this);
+    fileList_ = new QTreeWidget(this);
+    fileList_->setRootIsDecorated(false);
+    fileList_->setHeaderLabels({tr("File"), tr("Differences")});
+    fileList_->header()->setStretchLastSection(false);
+    fileList_->header()->setSectionResizeMode(static_cast<int>(Column::File), QHeaderView::Stretch);
+    fileList_->header()->setSectionResizeMode(static_cast<int>(Column::Differences), QHeaderView::ResizeToContents);
     fileList_->setContextMenuPolicy(Qt::ActionsContextMenu);
     fileList_->addAction(actions_.showInFileBrowser);
-    connect(fileList_, &QListWidget::itemSelectionChanged, this, &ShowDuplicatesDialog::updateActionsFromSelection);
+    connect(fileList_, &QTreeWidget::itemSelectionChanged, this, &ShowDuplicatesDialog::updateActionsFromSelection);
     layout->addWidget(fileList_);
 
     // Buttons
@@ -59,21 +80,26 @@ QString ShowDuplicatesDialog::getSelectedPath() const
     if (selection.empty()) {
         qFatal("Tried to get selected duplicate when nothing is selected.");
     }
-    return selection.first()->text();
+    return selection.first()->text(static_cast<int>(Column::File));
 }
 
 void ShowDuplicatesDialog::refreshDuplicates()
 {
-    RomLibrary::get()->getDuplicates(romInfo_)
+    RomLibrary::get()->getSimilar(romInfo_, maxLugEdits_->value())
         .then(
-            [this](const QList<RomInfo> &duplicates)
+            this,
+            [this](const QList<SimilarRom> &similarRoms)
             {
                 fileList_->clear();
-                for (const auto &duplicate : duplicates) {
-                    if (duplicate == romInfo_) {
-                        continue;
+                for (const auto &similarRom : similarRoms) {
+                    auto *item = new QTreeWidgetItem(fileList_);
+                    item->setText(static_cast<int>(Column::File), similarRom.romInfo.getFilePath());
+                    if (similarRom.lugEdits == 0) {
+                        item->setText(static_cast<int>(Column::Differences), tr("Identical"));
+                    }
+                    else {
+                        item->setText(static_cast<int>(Column::Differences), tr("%n lug(s)", "", static_cast<int>(similarRom.lugEdits)));
                     }
-                    fileList_->addItem(duplicate.getFilePath());
                 }
             }
         );
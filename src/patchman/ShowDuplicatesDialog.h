@@ -10,14 +10,15 @@
 #define SHOWDUPLICATESDIALOG_H
 
 #include <QDialog>
-#include <QListWidget>
+#include <QSpinBox>
+#include <QTreeWidget>
 #include "patchlib/library/RomInfo.h"
 
 namespace patchman
 {
 
 /**
- * Display duplicates of the given ROM.
+ * Display duplicates and near-duplicates of the given ROM, most similar first.
  */
 class ShowDuplicatesDialog: public QDialog
 {
@@ -32,7 +33,14 @@ private:
     };
     Actions actions_;
     RomInfo romInfo_;
-    QListWidget *fileList_;
+    QSpinBox *maxLugEdits_;
+    QTreeWidget *fileList_;
+
+    enum class Column
+    {
+        File,
+        Differences,
+    };
 
     QString getSelectedPath() const;
 
@@ -0,0 +1,23 @@
+/**
+ * @file SystemReportBuilder.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#include "SystemReportBuilder.h"
+#include "ReportData.h"
+
+namespace patchman
+{
+
+void SystemReportBuilder::render(std::ostream &out)
+{
+    inja::json data = SystemReportData::create(roms_).toJson();
+
+    auto temp = loadTemplate("system.html");
+    inja_.render_to(out, temp, data);
+}
+
+} // patchman
@@ -0,0 +1,42 @@
+/**
+ * @file SystemReportBuilder.h
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#ifndef SYSTEMREPORTBUILDER_H
+#define SYSTEMREPORTBUILDER_H
+
+#include "ReportBuilder.h"
+#include <utility>
+
+namespace patchman
+{
+
+/**
+ * Build one report for all the ROMs in a system, showing where each DMX address is patched across them.
+ */
+class SystemReportBuilder: public ReportBuilder
+{
+Q_OBJECT
+public:
+    /**
+     * @param roms Pairs of ROM names (usually file names) and ROMs, which must outlive this builder.
+     * @param parent
+     */
+    explicit SystemReportBuilder(QList<std::pair<QString, const Rom *>> roms, QObject *parent = nullptr)
+        : ReportBuilder(parent), roms_(std::move(roms))
+    {}
+
+protected:
+    void render(std::ostream &out) override;
+
+private:
+    QList<std::pair<QString, const Rom *>> roms_;
+};
+
+} // patchman
+
+#endif //SYSTEMREPORTBUILDER_H
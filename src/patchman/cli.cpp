@@ -0,0 +1,222 @@
+/**
+ * @file cli.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#include "cli.h"
+#include "patchman_config.h"
+#include "patchlib/Exceptions.h"
+#include "patchlib/RomDiff.h"
+#include "BatchReport.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QTextStream>
+#include <functional>
+#include <map>
+#include <memory>
+
+namespace patchman
+{
+
+/**
+ * Exit codes, following diff(1).
+ */
+enum ExitCode
+{
+    kExitSuccess = 0,
+    kExitSame = kExitSuccess,
+    kExitDifferent = 1,
+    kExitError = 2,
+};
+
+static QString tr(const char *sourceText, const char *disambiguation = nullptr, int n = -1)
+{
+    return QCoreApplication::translate("cli", sourceText, disambiguation, n);
+}
+
+/**
+ * Compare one ROM against any number of modified copies.
+ */
+static int diffCommand(const QStringList &args)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription(tr("Show lugs patched differently in each MODIFIED ROM than in SOURCE."));
+    parser.addHelpOption();
+    const QCommandLineOption briefOption(QStringList{"q", "brief"}, tr("Only report which ROMs differ."));
+    parser.addOption(briefOption);
+    parser.addPositionalArgument("SOURCE", tr("ROM to compare against."));
+    parser.addPositionalArgument("MODIFIED", tr("ROMs to compare."), "MODIFIED...");
+    parser.process(args);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    const auto paths = parser.positionalArguments();
+    if (paths.size() < 2) {
+        err << parser.helpText();
+        return kExitError;
+    }
+    const bool brief = parser.isSet(briefOption);
+
+    std::unique_ptr<Rom> source;
+    try {
+        source.reset(Rom::createFromFile(paths.front()));
+    }
+    catch (const PatchmanUserException &e) {
+        err << paths.front() << ": " << e.getMessage() << Qt::endl;
+        return kExitError;
+    }
+
+    int exitCode = kExitSame;
+    for (const auto &modifiedPath : paths.sliced(1)) {
+        std::unique_ptr<Rom> modified;
+        try {
+            modified.reset(Rom::createFromFile(modifiedPath));
+        }
+        catch (const PatchmanUserException &e) {
+            err << modifiedPath << ": " << e.getMessage() << Qt::endl;
+            exitCode = kExitError;
+            continue;
+        }
+
+        const auto diff = RomDiff::compare(*source, *modified);
+        if (diff.isEmpty()) {
+            continue;
+        }
+        if (exitCode == kExitSame) {
+            exitCode = kExitDifferent;
+        }
+        if (brief) {
+            out << tr("%1: %n lug(s) differ", nullptr, static_cast<int>(diff.getLugDiffs().size())).arg(modifiedPath)
+                << Qt::endl;
+            continue;
+        }
+
+        out << "--- " << paths.front() << Qt::endl << "+++ " << modifiedPath << Qt::endl;
+        if (diff.isRomTypeChanged()) {
+            out << tr("ROM types differ") << Qt::endl;
+        }
+        for (const auto &lugDiff : diff.getLugDiffs()) {
+            const auto where = tr("Rack %1, circuit %2").arg(lugDiff.rack).arg(lugDiff.circuit + 1);
+            if (lugDiff.isAddressChanged()) {
+                out << tr("%1: address %2 -> %3")
+                    .arg(where)
+                    .arg(lugDiff.getSourceAddress())
+                    .arg(lugDiff.getModifiedAddress()) << Qt::endl;
+            }
+            if (lugDiff.isAnalogChanged()) {
+                out << tr("%1: analog %2 -> %3")
+                    .arg(where)
+                    .arg(lugDiff.getSourceAnalog())
+                    .arg(lugDiff.getModifiedAnalog()) << Qt::endl;
+            }
+        }
+    }
+
+    return exitCode;
+}
+
+/**
+ * Create reports for ROM files, searching directories for them.
+ */
+static int reportCommand(const QStringList &args)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription(tr("Create a report for each ROM in PATH. Directories are searched for ROMs."));
+    parser.addHelpOption();
+    const QCommandLineOption outputOption(QStringList{"o", "output"},
+                                          tr("Write reports to DIR instead of the current directory."),
+                                          "DIR",
+                                          ".");
+    parser.addOption(outputOption);
+    const QCommandLineOption systemOption(QStringList{"s", "system"},
+                                          tr("Combine all ROMs into one system report, system.html."));
+    parser.addOption(systemOption);
+    parser.addPositionalArgument("PATH", tr("ROM files or directories."), "PATH...");
+    parser.process(args);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    const auto paths = parser.positionalArguments();
+    if (paths.empty()) {
+        err << parser.helpText();
+        return kExitError;
+    }
+    const auto outputDir = parser.value(outputOption);
+    if (!QDir().mkpath(outputDir)) {
+        err << tr("Cannot create output directory %1").arg(outputDir) << Qt::endl;
+        return kExitError;
+    }
+
+    const auto romPaths = BatchReport::findFiles(paths);
+    if (parser.isSet(systemOption)) {
+        const auto result = BatchReport::createSystem(romPaths, QDir(outputDir).filePath("system.html")).result();
+        if (result.status != BatchReport::Result::Status::Created) {
+            err << result.error << Qt::endl;
+            return kExitError;
+        }
+        out << result.reportPath << Qt::endl;
+        return kExitSuccess;
+    }
+
+    auto future = BatchReport::create(romPaths, outputDir);
+    int exitCode = kExitSuccess;
+    int skipped = 0;
+    // Results arrive in order, so this prints each one as soon as it and all before it are done.
+    for (int ix = 0; ix < romPaths.size(); ++ix) {
+        const auto result = future.resultAt(ix);
+        switch (result.status) {
+            case BatchReport::Result::Status::Created:
+                out << result.romPath << " -> " << result.reportPath << Qt::endl;
+                break;
+            case BatchReport::Result::Status::NotRom:
+                ++skipped;
+                break;
+            case BatchReport::Result::Status::Failed:
+                err << result.romPath << ": " << result.error << Qt::endl;
+                exitCode = kExitError;
+                break;
+        }
+    }
+    if (skipped > 0) {
+        err << tr("Skipped %n file(s) that are not ROMs.", nullptr, skipped) << Qt::endl;
+    }
+
+    return exitCode;
+}
+
+using Command = std::function<int(const QStringList &)>;
+
+static const std::map<QString, Command> &getCommands()
+{
+    static const std::map<QString, Command> commands{
+        {"diff", &diffCommand},
+        {"report", &reportCommand},
+    };
+    return commands;
+}
+
+bool isCliCommand(int argc, char *argv[])
+{
+    return argc > 1 && getCommands().contains(QString::fromLocal8Bit(argv[1]));
+}
+
+int runCli(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setOrganizationName(config::kProjectOrganizationName);
+    app.setOrganizationDomain(config::kProjectOrganizationDomain);
+    app.setApplicationName(config::kProjectName);
+    app.setApplicationVersion(config::kProjectVersion);
+
+    // Drop the command name so each command parses its own arguments.
+    auto args = app.arguments();
+    const auto command = args.takeAt(1);
+    args.front().append(' ').append(command);
+    return getCommands().at(command)(args);
+}
+
+} // patchman
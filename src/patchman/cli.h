@@ -0,0 +1,31 @@
+/**
+ * @file cli.h
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#ifndef CLI_H
+#define CLI_H
+
+namespace patchman
+{
+
+/**
+ * Was the program launched to run a command instead of the GUI?
+ *
+ * Commands are given as the first argument, e.g. `patchman diff SOURCE MODIFIED`.
+ */
+[[nodiscard]] bool isCliCommand(int argc, char *argv[]);
+
+/**
+ * Run the command given on the command line.
+ *
+ * @return Exit code.
+ */
+int runCli(int argc, char *argv[]);
+
+} // patchman
+
+#endif //CLI_H
@@ -17,6 +17,7 @@ D192RackPreviewModel::D192RackPreviewModel(D192Rack *rack, QObject *parent)
     , rack_(rack)
 {
     connect(rack_, &D192Rack::lugChanged, this, &D192RackPreviewModel::lugChanged);
+    connect(rack_, &D192Rack::lugRangeChanged, this, &D192RackPreviewModel::lugRangeChanged);
 }
 
 int D192RackPreviewModel::rowCount(const QModelIndex &parent) const
@@ -88,6 +89,18 @@ void D192RackPreviewModel::lugChanged(const unsigned int lug)
     const auto ix = lugIndex(lug);
     Q_EMIT(dataChanged(ix, ix));
 }
+
+void D192RackPreviewModel::lugRangeChanged(const unsigned int firstLug, const unsigned int lastLug)
+{
+    const auto firstIx = lugIndex(firstLug);
+    const auto lastIx = lugIndex(lastLug);
+    if (firstIx.column() == lastIx.column()) {
+        Q_EMIT(dataChanged(firstIx, lastIx));
+    } else {
+        // The range wraps around to the next column.
+        Q_EMIT(dataChanged(index(0, firstIx.column()), index(rowCount({}) - 1, lastIx.column())));
+    }
+}
 } // namespace detail
 
 D192RackPreview::D192RackPreview(D192Rack *rack, QWidget *parent)
@@ -11,12 +11,12 @@
 namespace patchman
 {
 
-std::string D192ReportBuilder::render()
+void D192ReportBuilder::render(std::ostream &out)
 {
     inja::json data = buildAddressTableData(rom_);
 
     auto temp = loadTemplate("d192.html");
-    return inja_.render(temp, data);
+    inja_.render_to(out, temp, data);
 }
 
 } // patchman
@@ -19,6 +19,7 @@ EnrRackPreviewModel::EnrRackPreviewModel(EnrRack *rack, QObject *parent)
     , rack_(rack)
 {
     connect(rack_, &EnrRack::lugChanged, this, &EnrRackPreviewModel::lugChanged);
+    connect(rack_, &EnrRack::lugRangeChanged, this, &EnrRackPreviewModel::lugRangeChanged);
 }
 
 int EnrRackPreviewModel::rowCount(const QModelIndex &parent) const
@@ -66,6 +67,11 @@ void EnrRackPreviewModel::lugChanged(unsigned int lug)
     Q_EMIT(dataChanged(ix, ix));
 }
 
+void EnrRackPreviewModel::lugRangeChanged(unsigned int firstLug, unsigned int lastLug)
+{
+    Q_EMIT(dataChanged(index(static_cast<int>(firstLug) / 2, 0), index(static_cast<int>(lastLug) / 2, 0)));
+}
+
 Qt::ItemFlags EnrRackPreviewModel::flags(const QModelIndex &index) const
 {
     return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
@@ -31,6 +31,7 @@ private:
 
 private Q_SLOTS:
     void lugChanged(unsigned int lug);
+    void lugRangeChanged(unsigned int firstLug, unsigned int lastLug);
 };
 } // namespace detail
 
@@ -11,12 +11,12 @@
 namespace patchman
 {
 
-std::string EnrReportBuilder::render()
+void EnrReportBuilder::render(std::ostream &out)
 {
     inja::json data = buildAddressTableData(rom_);
 
     auto temp = loadTemplate("enr.html");
-    return inja_.render(temp, data);
+    inja_.render_to(out, temp, data);
 }
 
 } // patchman
@@ -27,7 +27,7 @@ public:
     {}
 
 protected:
-    std::string render() override;
+    void render(std::ostream &out) override;
 
 private:
     const EnrRom *rom_;
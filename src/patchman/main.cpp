@@ -10,6 +10,7 @@
 #include "BrowserWindow.h"
 #include "DarkModeHandler.h"
 #include "Settings.h"
+#include "cli.h"
 #include "patchlib/library/RomLibrary.h"
 #include "patchman_config.h"
 #include "updater.h"
@@ -37,6 +38,12 @@ bool reallyClearSettings(QApplication &app)
 
 int main(int argc, char *argv[])
 {
+    Q_INIT_RESOURCE(bin);
+
+    if (patchman::isCliCommand(argc, argv)) {
+        return patchman::runCli(argc, argv);
+    }
+
     QIcon::setFallbackSearchPaths({":/icons"});
 
     QApplication app(argc, argv);
@@ -48,8 +55,6 @@ int main(int argc, char *argv[])
     const QIcon defaultWindowIcon(":/icons/patchman.svg");
     app.setWindowIcon(defaultWindowIcon);
 
-    Q_INIT_RESOURCE(bin);
-
     QTranslator qtTranslator;
     if (qtTranslator.load(QLocale(), "qtbase", "_", QLibraryInfo::path(QLibraryInfo::TranslationsPath))) {
         app.installTranslator(&qtTranslator);
@@ -9,9 +9,12 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_range_equals.hpp>
 #include <array>
+#include <memory>
+#include <vector>
 #include <QByteArrayView>
 #include "patchlib/Rom.h"
 #include "patchlib/Exceptions.h"
+#include "patchlib/RackDescriptor.h"
 #include "Formatters.h"
 
 using Catch::Matchers::RangeEquals;
@@ -1160,3 +1163,121 @@ TEST_CASE("D192 Save")
         }
     }
 }
+
+TEST_CASE("D192 Patch Table")
+{
+    const auto *testRom = getTestRom();
+    const auto patchTable = testRom->toPatchTable();
+    const auto *actual = patchman::Rom::fromPatchTable(patchTable);
+    REQUIRE(actual->getType() == patchman::Rom::Type::D192);
+    REQUIRE(*testRom == *actual);
+    REQUIRE_THROWS_AS(patchman::Rom::fromPatchTable(patchTable.first(patchTable.size() - 1)),
+                      patchman::InvalidRomException);
+}
+
+TEST_CASE("D192 Rack Descriptor")
+{
+    constexpr const auto &descriptor = patchman::RackTraits<patchman::Rack::Type::D192Rack>::kDescriptor;
+    STATIC_REQUIRE(descriptor.getCircuitForLug(64) == 2);
+    STATIC_REQUIRE(descriptor.getPhaseForLug(64) == patchman::Phase::B);
+
+    const auto *rack = getTestRom()->getRack(0);
+    REQUIRE(&rack->getDescriptor() == &descriptor);
+    for (unsigned int lug = 0; lug < descriptor.lugCount; ++lug) {
+        REQUIRE(descriptor.getLugForCircuit(descriptor.getCircuitForLug(lug)) == lug);
+        REQUIRE(descriptor.getModuleDensityForLug(rack->getLugWords(), lug) == rack->getModuleDensityForLug(lug));
+    }
+}
+
+TEST_CASE("D192 Bulk Lug Edit")
+{
+    auto *rack = getTestRom()->getRack(0);
+    unsigned int lugChangedCount = 0;
+    std::vector<std::pair<unsigned int, unsigned int>> ranges;
+    QObject::connect(rack, &patchman::Rack::lugChanged, [&lugChangedCount]()
+    {
+        ++lugChangedCount;
+    });
+    QObject::connect(rack, &patchman::Rack::lugRangeChanged, [&ranges](unsigned int firstLug, unsigned int lastLug)
+    {
+        ranges.emplace_back(firstLug, lastLug);
+    });
+
+    const std::array<patchman::Rack::LugEdit, 3> edits{
+        patchman::Rack::LugEdit{.lug = 70, .address = 512},
+        patchman::Rack::LugEdit{.lug = 3, .address = 0},
+        patchman::Rack::LugEdit{.lug = 12, .address = 1},
+    };
+    rack->setLugAddresses(edits);
+    REQUIRE(lugChangedCount == 0);
+    REQUIRE(ranges == std::vector<std::pair<unsigned int, unsigned int>>{{3, 70}});
+    REQUIRE(rack->getLugAddress(70) == 512);
+    REQUIRE(rack->getLugAddress(3) == 0);
+    REQUIRE(rack->getLugAddress(12) == 1);
+}
+
+TEST_CASE("D192 Snapshot")
+{
+    auto *testRom = getTestRom();
+    const auto snapshot = testRom->getSnapshot();
+    REQUIRE(snapshot.getPatchTable() == testRom->toPatchTable());
+
+    SECTION("Cached until edited") {
+        REQUIRE(testRom->getSnapshot().getPatchTable().constData() == snapshot.getPatchTable().constData());
+    }
+
+    SECTION("Edits make a new version") {
+        const auto before = snapshot.getPatchTable();
+        testRom->getRack(1)->setLugAddress(0, 512);
+        const auto edited = testRom->getSnapshot();
+        REQUIRE(edited.getEditVersion() > snapshot.getEditVersion());
+        REQUIRE(edited.getPatchTable() == testRom->toPatchTable());
+        // Existing snapshots are unchanged.
+        REQUIRE(snapshot.getPatchTable() == before);
+
+        const std::unique_ptr<patchman::Rom> copy(edited.toRom());
+        REQUIRE(*copy == *testRom);
+    }
+
+    SECTION("Removing a rack makes a new version") {
+        testRom->removeRack(3);
+        REQUIRE(testRom->getSnapshot().getEditVersion() > snapshot.getEditVersion());
+    }
+}
+
+TEST_CASE("D192 Lug Deltas")
+{
+    auto *testRom = getTestRom();
+    auto *rack = testRom->getRack(1);
+    const auto original = testRom->toPatchTable();
+    QList<patchman::Rack::LugDelta> deltas;
+    QObject::connect(rack, &patchman::Rack::lugsEdited, [&deltas](const QList<patchman::Rack::LugDelta> &edited)
+    {
+        deltas = edited;
+    });
+
+    const std::array<patchman::Rack::LugEdit, 3> edits{{
+        {.lug = 5, .address = 400},
+        {.lug = 2, .address = 401},
+        {.lug = 9, .address = rack->getLugAddress(9)},
+    }};
+    rack->setLugAddresses(edits);
+    // Unchanged lugs are left out.
+    REQUIRE(deltas.size() == 2);
+    CHECK(deltas[0].lug == 2);
+    CHECK(deltas[0].after == 401);
+    CHECK(deltas[1].lug == 5);
+    CHECK(deltas[1].after == 400);
+
+    const auto edited = testRom->toPatchTable();
+    const auto recorded = deltas;
+    deltas.clear();
+
+    // Undo and redo.
+    rack->applyLugDeltas(recorded, true);
+    REQUIRE(testRom->toPatchTable() == original);
+    rack->applyLugDeltas(recorded);
+    REQUIRE(testRom->toPatchTable() == edited);
+    // Neither is recorded as a new edit.
+    REQUIRE(deltas.empty());
+}
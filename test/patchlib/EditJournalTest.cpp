@@ -0,0 +1,71 @@
+/**
+ * @file EditJournalTest.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <array>
+#include <memory>
+#include "patchlib/EditJournal.h"
+#include "patchlib/Enr.h"
+
+TEST_CASE("Edit Journal")
+{
+    QTemporaryDir journalDir;
+    REQUIRE(journalDir.isValid());
+    qputenv("PATCHMAN_JOURNAL_DIR", journalDir.path().toUtf8());
+
+    const QString romPath(TEST_SOURCES_DIR "/roms/enr_bal_294.bin");
+    const std::unique_ptr<patchman::Rom> rom(patchman::Rom::createFromFile(romPath));
+    const std::unique_ptr<patchman::EditJournal> journal(patchman::EditJournal::create(rom.get(), romPath));
+    REQUIRE(journal != nullptr);
+    // Held by this session.
+    CHECK(patchman::EditJournal::findAbandoned().empty());
+
+    auto *rack = dynamic_cast<patchman::EnrRack *>(rom->getRack(2));
+    REQUIRE(rack != nullptr);
+    rack->setLugAddress(10, 512);
+    rack->setLugAnalogChan(95, (rack->getLugAnalogChan(95) + 1) % (patchman::EnrRack::kMaxAnalog + 1));
+    const std::array<patchman::Rack::LugEdit, 2> edits{{{.lug = 0, .address = 1}, {.lug = 3, .address = 4}}};
+    rack->setLugAddresses(edits);
+    journal->flush();
+
+    SECTION("Recover") {
+        // Simulate a crash by reading the journal while it is still open.
+        const auto journalPaths = QDir(journalDir.path()).entryList({"*.journal"}, QDir::Files);
+        REQUIRE(journalPaths.size() == 1);
+        const auto recovered = patchman::EditJournal::recover(QDir(journalDir.path()).filePath(journalPaths.front()));
+        const std::unique_ptr<patchman::Rom> recoveredRom(recovered.rom);
+        CHECK(recovered.romPath == romPath);
+        REQUIRE(*recoveredRom == *rom);
+        CHECK(recoveredRom->toByteArray() == rom->toByteArray());
+    }
+
+    SECTION("Incomplete record") {
+        const auto journalPaths = QDir(journalDir.path()).entryList({"*.journal"}, QDir::Files);
+        REQUIRE(journalPaths.size() == 1);
+        const auto journalPath = QDir(journalDir.path()).filePath(journalPaths.front());
+        // Start a record for lugs 0-2 of rack 2, but only write one word of it.
+        QFile file(journalPath);
+        REQUIRE(file.open(QFile::Append));
+        file.write(QByteArray::fromHex("0200000303"));
+        file.close();
+
+        const auto recovered = patchman::EditJournal::recover(journalPath);
+        const std::unique_ptr<patchman::Rom> recoveredRom(recovered.rom);
+        REQUIRE(*recoveredRom == *rom);
+    }
+
+    SECTION("Discard") {
+        journal->discard();
+        CHECK(QDir(journalDir.path()).entryList({"*.journal"}, QDir::Files).empty());
+    }
+
+    qunsetenv("PATCHMAN_JOURNAL_DIR");
+}
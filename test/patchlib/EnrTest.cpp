@@ -9,9 +9,14 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_range_equals.hpp>
 #include <QByteArray>
+#include <QCryptographicHash>
 #include <QFile>
+#include <algorithm>
+#include <memory>
+#include <vector>
 #include "patchlib/Enr.h"
 #include "patchlib/Exceptions.h"
+#include "patchlib/SoftwareImageStore.h"
 #include "Formatters.h"
 
 class EnrFixture
@@ -722,3 +727,70 @@ TEST_CASE_METHOD(EnrFixture, "ENR Save")
         }
     }
 }
+
+TEST_CASE_METHOD(EnrFixture, "ENR Patch Table")
+{
+    const auto *actual = dynamic_cast<patchman::EnrRom *>(patchman::Rom::fromPatchTable(rom_->toPatchTable()));
+    REQUIRE(actual != nullptr);
+    REQUIRE(actual->getVersion() == patchman::EnrRom::Version::EnrRack294);
+    REQUIRE(actual->toByteArray() == romBin_);
+}
+
+TEST_CASE_METHOD(EnrFixture, "ENR Software Interning")
+{
+    const auto software = romBin_.first(0x3000);
+    const auto softwareHash = QCryptographicHash::hash(software, QCryptographicHash::Algorithm::Sha256);
+    auto &store = patchman::SoftwareImageStore::get();
+    const auto sizeBefore = store.size();
+    const std::unique_ptr<patchman::Rom> first(patchman::Rom::create(patchman::Rom::Type::ENR));
+    first->loadFromData(romBin_);
+    const std::unique_ptr<patchman::Rom> second(patchman::Rom::create(patchman::Rom::Type::ENR));
+    second->loadFromData(romBin_);
+    // Known software versions are only interned once the software is needed; only the trailer is kept on load.
+    CHECK(store.size() <= sizeBefore + 1);
+
+    CHECK(first->toByteArray() == romBin_);
+    CHECK(second->toByteArray() == romBin_);
+    // Each stored image is exactly the bytes its hash was taken from.
+    const auto stored = store.find(softwareHash);
+    REQUIRE(stored == software);
+    const auto trailer = romBin_.sliced(0x3C00);
+    const auto trailerHash = QCryptographicHash::hash(trailer, QCryptographicHash::Algorithm::Sha256);
+    CHECK(store.find(trailerHash) == trailer);
+    // Both ROMs share the stored software and trailer, and interning the same software again must not make a copy.
+    CHECK(store.size() <= sizeBefore + 2);
+    CHECK(store.intern(software, softwareHash).constData() == stored.constData());
+}
+
+TEST_CASE_METHOD(EnrFixture, "ENR Save Loaded")
+{
+    // Loaded ROMs are saved from their own bytes, including the bytes after the patch tables.
+    auto romBin = romBin_;
+    romBin[romBin.size() - 1] = static_cast<char>(0x5A);
+    const std::unique_ptr<patchman::Rom> rom(patchman::Rom::create(patchman::Rom::Type::ENR));
+    rom->loadFromData(romBin);
+    const auto actual = rom->toByteArray();
+    REQUIRE(actual.size() == 16384);
+    CHECK(actual == romBin);
+    uint32_t checksum = 0;
+    for (const uint8_t byte : romBin) {
+        checksum += byte;
+    }
+    CHECK(rom->getChecksum() == QByteArray::fromHex(QByteArray::number(checksum, 16).rightJustified(8, '0')));
+}
+
+TEST_CASE_METHOD(EnrFixture, "ENR Lugs View")
+{
+    const auto *rack = rom_->getRack(0);
+    const auto lugsView = rack->getLugsView();
+    STATIC_REQUIRE(std::ranges::random_access_range<decltype(lugsView)>);
+    STATIC_REQUIRE(std::ranges::sized_range<decltype(lugsView)>);
+    REQUIRE(std::ranges::size(lugsView) == rack->getLugCount());
+    REQUIRE(lugsView[28] == patchman::Rack::LugEntry{.lug = 28, .address = 85, .analog = 4});
+
+    // The view can be reused and sorted.
+    std::vector<patchman::Rack::LugEntry> byAnalog(lugsView.begin(), lugsView.end());
+    std::ranges::stable_sort(byAnalog, std::ranges::greater(), &patchman::Rack::LugEntry::analog);
+    REQUIRE(byAnalog.front().analog == 4);
+    REQUIRE(std::ranges::equal(lugsView, rack->getLugsView()));
+}
@@ -0,0 +1,55 @@
+/**
+ * @file RomDiffTest.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <memory>
+#include "patchlib/RomDiff.h"
+
+TEST_CASE("ROM Diff")
+{
+    const QString romPath(TEST_SOURCES_DIR "/roms/enr_bal_294.bin");
+    const std::unique_ptr<patchman::Rom> source(patchman::Rom::createFromFile(romPath));
+    const std::unique_ptr<patchman::Rom> modified(patchman::Rom::createFromFile(romPath));
+
+    SECTION("Identical") {
+        const auto diff = patchman::RomDiff::compare(*source, *modified);
+        CHECK(diff.isEmpty());
+        CHECK(diff.getLugDiffs().empty());
+    }
+
+    SECTION("Modified") {
+        auto *rack = dynamic_cast<patchman::EnrRack *>(modified->getRack(2));
+        REQUIRE(rack != nullptr);
+        const auto oldAddress = rack->getLugAddress(10);
+        const auto oldAnalog = rack->getLugAnalogChan(95);
+        rack->setLugAddress(10, 512);
+        rack->setLugAnalogChan(95, (oldAnalog + 1) % (patchman::EnrRack::kMaxAnalog + 1));
+
+        const auto diff = patchman::RomDiff::compare(*source, *modified);
+        CHECK_FALSE(diff.isEmpty());
+        CHECK_FALSE(diff.isRomTypeChanged());
+        REQUIRE(diff.getLugDiffs().size() == 2);
+
+        const auto &addressDiff = diff.getLugDiffs().at(0);
+        CHECK(addressDiff.rack == 2);
+        CHECK(addressDiff.lug == 10);
+        CHECK(addressDiff.circuit == rack->getCircuitForLug(10));
+        CHECK(addressDiff.isAddressChanged());
+        CHECK_FALSE(addressDiff.isAnalogChanged());
+        CHECK(addressDiff.getSourceAddress() == oldAddress);
+        CHECK(addressDiff.getModifiedAddress() == 512);
+
+        const auto &analogDiff = diff.getLugDiffs().at(1);
+        CHECK(analogDiff.rack == 2);
+        CHECK(analogDiff.lug == 95);
+        CHECK_FALSE(analogDiff.isAddressChanged());
+        CHECK(analogDiff.isAnalogChanged());
+        CHECK(analogDiff.getSourceAnalog() == oldAnalog);
+        CHECK(analogDiff.getModifiedAnalog() == rack->getLugAnalogChan(95));
+    }
+}
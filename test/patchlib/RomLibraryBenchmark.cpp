@@ -0,0 +1,357 @@
+/**
+ * @file RomLibraryBenchmark.cpp
+ *
+ * Measure library scans against a large synthetic library, and compare the database schema against the one it replaced.
+ * Hidden from the default test run; run it on its own with `patchlib_test "[benchmark]"` so the database path set here
+ * is the first one the library sees.
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include "patchlib/library/RomLibrary.h"
+#include "patchlib/Rom.h"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QRandomGenerator>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QTimeZone>
+#include <thread>
+
+static QList<patchman::RomInfo> scanLibrary(const QStringList &searchPaths)
+{
+    auto future = patchman::RomLibrary::get()->getAllRoms(searchPaths);
+    while (!future.isFinished()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    }
+    return future.result();
+}
+
+TEST_CASE("Library Scan", "[.][benchmark]")
+{
+    constexpr auto kRomCount = 5000;
+    constexpr auto kDirCount = 50;
+    QTemporaryDir libraryDir;
+    QTemporaryDir dbDir;
+    REQUIRE(libraryDir.isValid());
+    REQUIRE(dbDir.isValid());
+    const auto dbPath = dbDir.filePath("patchman.db");
+    qputenv("PATCHMAN_DB_PATH", dbPath.toUtf8());
+
+    // Synthetic D192 ROMs, 4 racks each, with a random half of each rack patched.
+    QRandomGenerator rng(0x50544348);
+    for (int dirNum = 0; dirNum < kDirCount; ++dirNum) {
+        QDir(libraryDir.path()).mkdir(QString::number(dirNum));
+    }
+    for (int romNum = 0; romNum < kRomCount; ++romNum) {
+        QByteArray data(2048, static_cast<char>(0xFF));
+        for (int rack = 0; rack < 4; ++rack) {
+            for (int lug = 0; lug < 192; lug += 2) {
+                data[rack * 512 + static_cast<int>(rng.bounded(512))] = static_cast<char>(lug);
+            }
+        }
+        QFile romFile(QDir(libraryDir.filePath(QString::number(romNum % kDirCount)))
+                          .filePath(QString("rom_%1.bin").arg(romNum)));
+        REQUIRE(romFile.open(QFile::WriteOnly));
+        romFile.write(data);
+    }
+
+    const QStringList searchPaths{libraryDir.path()};
+    QElapsedTimer timer;
+    timer.start();
+    auto roms = scanLibrary(searchPaths);
+    const auto coldMs = timer.restart();
+    roms = scanLibrary(searchPaths);
+    const auto warmMs = timer.elapsed();
+
+    REQUIRE(roms.size() == kRomCount);
+    WARN("ROMs: " << kRomCount
+                  << "\nCold scan: " << coldMs << " ms"
+                  << "\nWarm scan: " << warmMs << " ms"
+                  << "\nDatabase size: " << QFileInfo(dbPath).size() << " bytes");
+}
+
+/**
+ * A row of the synthetic library used by the schema comparison.
+ */
+struct SyntheticRomRow
+{
+    QString dirPath;
+    QString fileName;
+    QDateTime fileMTime;
+    QByteArray softwareHash;
+    QByteArray patchHash;
+    QByteArray romChecksum;
+};
+
+static QSqlDatabase openSchemaDb(const QString &connectionName, const QString &path)
+{
+    auto db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+    db.setDatabaseName(path);
+    REQUIRE(db.open());
+    QSqlQuery(db).exec("PRAGMA journal_mode=WAL;");
+    return db;
+}
+
+/**
+ * Build the schema used before directories were split out of file paths: one text primary key compared with NOCASE
+ * and a text modification time.
+ */
+static void createOldSchema(QSqlDatabase &db, const QList<SyntheticRomRow> &rows)
+{
+    QSqlQuery q(db);
+    REQUIRE(q.exec(R"(
+create table rom_info
+(
+    file_path    text primary key not null collate NOCASE,
+    file_mtime   text,
+    hash_algo    integer,
+    software_hash BLOB,
+    patch_hash   BLOB,
+    rom_type     integer,
+    rack_count   integer,
+    rom_checksum BLOB
+);
+)"));
+    REQUIRE(q.exec("create index rom_info_patch_hash_index on rom_info (patch_hash);"));
+
+    REQUIRE(db.transaction());
+    REQUIRE(q.prepare("INSERT INTO rom_info VALUES(?, ?, ?, ?, ?, ?, ?, ?);"));
+    for (const auto &row : rows) {
+        q.bindValue(0, QString("%1/%2").arg(row.dirPath, row.fileName));
+        q.bindValue(1, row.fileMTime);
+        q.bindValue(2, QCryptographicHash::Sha256);
+        q.bindValue(3, row.softwareHash);
+        q.bindValue(4, row.patchHash);
+        q.bindValue(5, static_cast<int>(patchman::Rom::Type::D192));
+        q.bindValue(6, 4);
+        q.bindValue(7, row.romChecksum);
+        REQUIRE(q.exec());
+    }
+    REQUIRE(db.commit());
+}
+
+/**
+ * Build the current directory and ROM tables.
+ */
+static void createNewSchema(QSqlDatabase &db, const QList<SyntheticRomRow> &rows)
+{
+    using patchman::RomInfo;
+    QSqlQuery q(db);
+    REQUIRE(q.exec(QString("create table %1 (id integer primary key, %2 text not null unique);")
+                       .arg(RomInfo::kDirTable, RomInfo::kColDirPath)));
+    REQUIRE(q.exec(QString(R"(
+create table %1
+(
+    %2  integer primary key,
+    %3  integer not null references %4 (id) on delete cascade,
+    %5  text not null,
+    %6  integer,
+    %7  integer,
+    %8  BLOB,
+    %9  BLOB,
+    %10 integer,
+    %11 integer,
+    %12 BLOB,
+    %13 BLOB,
+    unique (%3, %5)
+);
+)")
+                       .arg(RomInfo::kTable)
+                       .arg(RomInfo::kColId)
+                       .arg(RomInfo::kColDirId)
+                       .arg(RomInfo::kDirTable)
+                       .arg(RomInfo::kColFileName)
+                       .arg(RomInfo::kColFileMTime)
+                       .arg(RomInfo::kColHashAlgo)
+                       .arg(RomInfo::kColSoftwareHash)
+                       .arg(RomInfo::kColPatchHash)
+                       .arg(RomInfo::kColRomType)
+                       .arg(RomInfo::kColRackCount)
+                       .arg(RomInfo::kColRomChecksum)
+                       .arg(RomInfo::kColSignature)));
+    REQUIRE(q.exec(QString("create index rom_info_patch_hash_index on %1 (%2);")
+                       .arg(RomInfo::kTable, RomInfo::kColPatchHash)));
+
+    REQUIRE(db.transaction());
+    QSqlQuery dirQ(db);
+    REQUIRE(dirQ.prepare(QString("INSERT INTO %1(%2) VALUES(?);").arg(RomInfo::kDirTable, RomInfo::kColDirPath)));
+    REQUIRE(q.prepare(QString("INSERT INTO %1(%2, %3, %4) VALUES(?, ?, %5);")
+                          .arg(RomInfo::kTable, RomInfo::kColDirId, RomInfo::kColFileName)
+                          .arg(RomInfo::kDataColumns.join(", "))
+                          .arg(QStringList(RomInfo::kDataColumns.size(), "?").join(", "))));
+    QHash<QString, qint64> dirIds;
+    for (const auto &row : rows) {
+        auto dirId = dirIds.value(row.dirPath);
+        if (dirId == 0) {
+            dirQ.bindValue(0, row.dirPath);
+            REQUIRE(dirQ.exec());
+            dirId = dirQ.lastInsertId().toLongLong();
+            dirIds.insert(row.dirPath, dirId);
+        }
+        patchman::RomInfo romInfo;
+        romInfo.setFileMTime(row.fileMTime);
+        romInfo.setHashAlgo(QCryptographicHash::Sha256);
+        romInfo.setSoftwareHash(row.softwareHash);
+        romInfo.setPatchHash(row.patchHash);
+        romInfo.setRomType(static_cast<int>(patchman::Rom::Type::D192));
+        romInfo.setRackCount(4);
+        romInfo.setRomChecksum(row.romChecksum);
+        q.bindValue(0, dirId);
+        q.bindValue(1, row.fileName);
+        romInfo.bind(q, 2);
+        REQUIRE(q.exec());
+    }
+    REQUIRE(db.commit());
+}
+
+TEST_CASE("Library Schema", "[.][benchmark]")
+{
+    constexpr auto kRomCount = 100'000;
+    constexpr auto kDirCount = 1000;
+    constexpr auto kLookupCount = 20'000;
+    QTemporaryDir dbDir;
+    REQUIRE(dbDir.isValid());
+
+    QRandomGenerator rng(0x50544348);
+    const auto randomBytes = [&rng](int size)
+    {
+        QByteArray bytes(size, Qt::Uninitialized);
+        for (auto &byte : bytes) {
+            byte = static_cast<char>(rng.bounded(256));
+        }
+        return bytes;
+    };
+    QList<SyntheticRomRow> rows;
+    rows.reserve(kRomCount);
+    const auto baseMTime = QDateTime(QDate(2020, 1, 1), QTime(0, 0), QTimeZone::utc());
+    for (int romNum = 0; romNum < kRomCount; ++romNum) {
+        rows.push_back({
+            .dirPath = QString("/Users/lighting/Documents/Patchman/Library/Venue %1/Patch").arg(romNum % kDirCount),
+            .fileName = QString("rom_%1.bin").arg(romNum),
+            .fileMTime = baseMTime.addMSecs(rng.bounded(1'000'000'000)),
+            .softwareHash = randomBytes(32),
+            .patchHash = randomBytes(32),
+            .romChecksum = randomBytes(4),
+        });
+    }
+    QList<qsizetype> lookups;
+    lookups.reserve(kLookupCount);
+    for (int lookupNum = 0; lookupNum < kLookupCount; ++lookupNum) {
+        lookups.push_back(rng.bounded(kRomCount));
+    }
+
+    const auto oldPath = dbDir.filePath("old.db");
+    const auto newPath = dbDir.filePath("new.db");
+    qint64 oldSize;
+    qint64 newSize;
+    qint64 oldLookupMs;
+    qint64 newLookupMs;
+    qint64 oldHydrateMs;
+    qint64 newHydrateMs;
+    QElapsedTimer timer;
+    {
+        auto db = openSchemaDb("old_schema", oldPath);
+        createOldSchema(db, rows);
+        QSqlQuery(db).exec("PRAGMA wal_checkpoint(TRUNCATE);");
+        oldSize = QFileInfo(oldPath).size();
+
+        // What a scan does for every file it finds: check the stored modification time.
+        QSqlQuery lookupQ(db);
+        REQUIRE(lookupQ.prepare("SELECT file_mtime FROM rom_info WHERE file_path = ? LIMIT 1;"));
+        timer.start();
+        for (const auto romNum : lookups) {
+            const auto &row = rows.at(romNum);
+            lookupQ.bindValue(0, QString("%1/%2").arg(row.dirPath, row.fileName));
+            REQUIRE(lookupQ.exec());
+            REQUIRE(lookupQ.next());
+            REQUIRE(lookupQ.value(0).toDateTime() == row.fileMTime);
+            lookupQ.finish();
+        }
+        oldLookupMs = timer.elapsed();
+
+        // Every row, hydrated the way it was before: by column name, with a text date.
+        QSqlQuery allQ(db);
+        allQ.setForwardOnly(true);
+        timer.start();
+        REQUIRE(allQ.exec("SELECT * FROM rom_info;"));
+        QList<patchman::RomInfo> roms;
+        roms.reserve(kRomCount);
+        while (allQ.next()) {
+            patchman::RomInfo romInfo;
+            romInfo.setFilePath(allQ.value("file_path").toString());
+            romInfo.setFileMTime(allQ.value("file_mtime").toDateTime());
+            romInfo.setHashAlgo(allQ.value("hash_algo").toInt());
+            romInfo.setSoftwareHash(allQ.value("software_hash").toByteArray());
+            romInfo.setPatchHash(allQ.value("patch_hash").toByteArray());
+            romInfo.setRomType(allQ.value("rom_type").toInt());
+            romInfo.setRackCount(allQ.value("rack_count").toUInt());
+            romInfo.setRomChecksum(allQ.value("rom_checksum").toByteArray());
+            roms.push_back(romInfo);
+        }
+        oldHydrateMs = timer.elapsed();
+        REQUIRE(roms.size() == kRomCount);
+    }
+    {
+        auto db = openSchemaDb("new_schema", newPath);
+        createNewSchema(db, rows);
+        QSqlQuery(db).exec("PRAGMA wal_checkpoint(TRUNCATE);");
+        newSize = QFileInfo(newPath).size();
+
+        // Scans look each directory up once, then each file by (directory, name).
+        QSqlQuery dirQ(db);
+        REQUIRE(dirQ.prepare(QString("SELECT id FROM %1 WHERE %2 = ?;")
+                                 .arg(patchman::RomInfo::kDirTable, patchman::RomInfo::kColDirPath)));
+        QSqlQuery lookupQ(db);
+        REQUIRE(lookupQ.prepare(QString("SELECT %1 FROM %2 WHERE %3 = ? AND %4 = ? LIMIT 1;")
+                                    .arg(patchman::RomInfo::kColFileMTime, patchman::RomInfo::kTable,
+                                         patchman::RomInfo::kColDirId, patchman::RomInfo::kColFileName)));
+        QHash<QString, qint64> dirIds;
+        timer.start();
+        for (const auto romNum : lookups) {
+            const auto &row = rows.at(romNum);
+            auto dirId = dirIds.value(row.dirPath);
+            if (dirId == 0) {
+                dirQ.bindValue(0, row.dirPath);
+                REQUIRE(dirQ.exec());
+                REQUIRE(dirQ.next());
+                dirId = dirQ.value(0).toLongLong();
+                dirQ.finish();
+                dirIds.insert(row.dirPath, dirId);
+            }
+            lookupQ.bindValue(0, dirId);
+            lookupQ.bindValue(1, row.fileName);
+            REQUIRE(lookupQ.exec());
+            REQUIRE(lookupQ.next());
+            REQUIRE(lookupQ.value(0).toLongLong() == row.fileMTime.toMSecsSinceEpoch() * 1'000'000);
+            lookupQ.finish();
+        }
+        newLookupMs = timer.elapsed();
+
+        QSqlQuery allQ(db);
+        allQ.setForwardOnly(true);
+        timer.start();
+        REQUIRE(allQ.exec(patchman::RomInfo::getSelectSql()));
+        QList<patchman::RomInfo> roms;
+        roms.reserve(kRomCount);
+        while (allQ.next()) {
+            roms.push_back(patchman::RomInfo::hydrate(allQ));
+        }
+        newHydrateMs = timer.elapsed();
+        REQUIRE(roms.size() == kRomCount);
+    }
+    QSqlDatabase::removeDatabase("old_schema");
+    QSqlDatabase::removeDatabase("new_schema");
+
+    WARN("ROMs: " << kRomCount << " in " << kDirCount << " directories"
+                  << "\nDatabase size: " << oldSize << " bytes before, " << newSize << " bytes now"
+                  << "\n" << kLookupCount << " lookups: " << oldLookupMs << " ms before, " << newLookupMs << " ms now"
+                  << "\nHydrate all: " << oldHydrateMs << " ms before, " << newHydrateMs << " ms now");
+}
@@ -9,9 +9,17 @@
 #include <catch2/catch_test_macros.hpp>
 #include "patchlib/library/RomLibrary.h"
 #include <QStringList>
+#include <QDir>
 #include <QFutureWatcher>
 #include <QFileInfo>
 #include <QCryptographicHash>
+#include <QFile>
+#include <QSet>
+#include <QTemporaryDir>
+#include <QtConcurrent>
+#include <atomic>
+#include <mutex>
+#include <tuple>
 #include "Formatters.h"
 #include "patchlib/Enr.h"
 
@@ -38,6 +46,41 @@ public:
             qunsetenv("PATCHMAN_DB_PATH");
         }
     }
+
+protected:
+    /**
+     * Scan @p searchPaths and wait for the result.
+     */
+    static QList<patchman::RomInfo> scan(const QStringList &searchPaths)
+    {
+        auto future = patchman::RomLibrary::get()->getAllRoms(searchPaths);
+        // Can't use waitForFinished() because Qt insists on running the functor in the main thread when that is used.
+        // See https://stackoverflow.com/a/69116706. QFutureWatcher fails as well.
+        while (!future.isFinished()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{500});
+        }
+        return future.result();
+    }
+
+    /**
+     * Occupy the library's writer thread until @p released is set, so work requested meanwhile stays queued.
+     */
+    static QFuture<void> holdWriter(const std::atomic_bool &released)
+    {
+        std::atomic_bool holding = false;
+        auto future = QtConcurrent::run(&patchman::RomLibrary::get()->pool_, [&holding, &released]()
+        {
+            holding = true;
+            while (!released) {
+                std::this_thread::sleep_for(std::chrono::milliseconds{10});
+            }
+        });
+        while (!holding) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        }
+        return future;
+    }
+
 private:
     std::string oldPatchmanDbPath_;
 };
@@ -47,20 +90,17 @@ TEST_CASE_METHOD(RomLibraryFixture, "Find All ROMs")
     const QStringList searchPaths{
         QString(TEST_SOURCES_DIR "/roms")
     };
-    auto future = patchman::RomLibrary::get()->getAllRoms(searchPaths);
-    // Can't use waitForFinished() because Qt insists on running the functor in the main thread when that is used.
-    // See https://stackoverflow.com/a/69116706. QFutureWatcher fails as well.
-    while (!future.isFinished()) {
-        std::this_thread::sleep_for(std::chrono::milliseconds{500});
-    }
-    const auto roms = future.result();
+    const auto roms = scan(searchPaths);
     REQUIRE(roms.size() == 1);
     const auto &actualRomInfo = roms.first();
     const auto expectedFilePath = QString(TEST_SOURCES_DIR "/roms/enr_bal_294.bin");
     auto *expectedRom = dynamic_cast<patchman::EnrRom *>(patchman::Rom::create(patchman::Rom::Type::ENR));
     expectedRom->loadFromFile(expectedFilePath);
     CHECK(actualRomInfo.getFilePath() == expectedFilePath);
+    CHECK(actualRomInfo.getId() > 0);
     CHECK(actualRomInfo.getFileMTime().toUTC() == QFileInfo(expectedFilePath).lastModified().toUTC());
+    CHECK(actualRomInfo.getFileMTimeNs()
+              == QFileInfo(expectedFilePath).lastModified().toMSecsSinceEpoch() * 1'000'000);
     CHECK(actualRomInfo.getHashAlgo() == QCryptographicHash::Sha256);
     CHECK(actualRomInfo.getSoftwareHash()
               == QByteArray::fromHex("1c55981980eeb717264713ce336169dd3fa79d0716374719cc49351cd435ca5d"));
@@ -70,3 +110,217 @@ TEST_CASE_METHOD(RomLibraryFixture, "Find All ROMs")
     CHECK(actualRomInfo.getRackCount() == 6);
     CHECK(actualRomInfo.getRomChecksum() == QByteArray::fromHex("0018ef52"));
 }
+
+TEST_CASE_METHOD(RomLibraryFixture, "Rescan ROMs")
+{
+    const QStringList searchPaths{
+        QString(TEST_SOURCES_DIR "/roms")
+    };
+    const auto first = scan(searchPaths);
+    const auto second = scan(searchPaths);
+    REQUIRE(first.size() == 1);
+    REQUIRE(second.size() == 1);
+    // Unchanged files keep their row.
+    CHECK(first.first().getId() == second.first().getId());
+    CHECK(first.first() == second.first());
+}
+
+TEST_CASE_METHOD(RomLibraryFixture, "Count Patch Hashes")
+{
+    const QStringList searchPaths{
+        QString(TEST_SOURCES_DIR "/roms")
+    };
+    REQUIRE(scan(searchPaths).size() == 1);
+    auto future = patchman::RomLibrary::get()->getPatchHashCounts();
+    while (!future.isFinished()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{500});
+    }
+    const auto counts = future.result();
+    REQUIRE(counts.size() == 1);
+    CHECK(counts.value(QByteArray::fromHex("90d236b6f8b8f5cce488bfa018078175dd21e902c8f0043829815ef8cdb78816")) == 1);
+}
+
+TEST_CASE_METHOD(RomLibraryFixture, "Stored Patch Table")
+{
+    const QStringList searchPaths{
+        QString(TEST_SOURCES_DIR "/roms")
+    };
+    const auto roms = scan(searchPaths);
+    REQUIRE(roms.size() == 1);
+    auto future = patchman::RomLibrary::get()->getPatchTable(roms.first());
+    while (!future.isFinished()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{500});
+    }
+    auto *expectedRom = patchman::Rom::create(patchman::Rom::Type::ENR);
+    expectedRom->loadFromFile(roms.first().getFilePath());
+    CHECK(future.result() == expectedRom->toPatchTable());
+}
+
+TEST_CASE_METHOD(RomLibraryFixture, "Find Address")
+{
+    const QStringList searchPaths{
+        QString(TEST_SOURCES_DIR "/roms")
+    };
+    const auto roms = scan(searchPaths);
+    REQUIRE(roms.size() == 1);
+    auto future = patchman::RomLibrary::get()->findAddress(1, 0);
+    while (!future.isFinished()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{500});
+    }
+    const auto matches = future.result();
+    REQUIRE(matches.size() == 1);
+    CHECK(matches.first().romId == roms.first().getId());
+    CHECK(matches.first().rack == 0);
+    CHECK(matches.first().lug == 0);
+    CHECK(matches.first().circuit == 0);
+}
+
+TEST_CASE_METHOD(RomLibraryFixture, "Similarity Matrix")
+{
+    QTemporaryDir libraryDir;
+    REQUIRE(libraryDir.isValid());
+    const auto romA = libraryDir.filePath("a.bin");
+    const auto romB = libraryDir.filePath("b.bin");
+    REQUIRE(QFile::copy(TEST_SOURCES_DIR "/roms/enr_bal_294.bin", romA));
+    REQUIRE(QFile::copy(TEST_SOURCES_DIR "/roms/enr_bal_294.bin", romB));
+    REQUIRE(scan({libraryDir.path()}).size() == 2);
+
+    const auto compareAll = []()
+    {
+        std::mutex rowsMutex;
+        QList<std::tuple<QString, QString, double>> rows;
+        auto future = patchman::RomLibrary::get()->getSimilarityMatrix(
+            [&rowsMutex, &rows](const QList<patchman::RomPairSimilarity> &pairs, const QHash<qint64, QString> &romPaths)
+            {
+                std::scoped_lock rowsGuard(rowsMutex);
+                for (const auto &pair : pairs) {
+                    rows.push_back({romPaths.value(pair.lhs), romPaths.value(pair.rhs), pair.similarity});
+                }
+            });
+        while (!future.isFinished()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{500});
+        }
+        return rows;
+    };
+    const auto rows = compareAll();
+    REQUIRE(rows.size() == 1);
+    const auto &[lhsPath, rhsPath, similarity] = rows.first();
+    CHECK(QSet<QString>{lhsPath, rhsPath} == QSet<QString>{romA, romB});
+    CHECK(similarity == 1.0);
+
+    // Now from the cache.
+    CHECK(compareAll() == rows);
+}
+
+TEST_CASE_METHOD(RomLibraryFixture, "Queued Scans")
+{
+    auto *library = patchman::RomLibrary::get();
+    const QStringList searchPaths{
+        QString(TEST_SOURCES_DIR "/roms")
+    };
+    REQUIRE(scan(searchPaths).size() == 1);
+    QTemporaryDir otherLibraryDir;
+    REQUIRE(otherLibraryDir.isValid());
+    REQUIRE(QFile::copy(TEST_SOURCES_DIR "/roms/enr_bal_294.bin", otherLibraryDir.filePath("a.bin")));
+    REQUIRE(QFile::copy(TEST_SOURCES_DIR "/roms/enr_bal_294.bin", otherLibraryDir.filePath("b.bin")));
+
+    std::atomic_bool released = false;
+    auto holdFuture = holdWriter(released);
+
+    SECTION("Identical Request")
+    {
+        auto first = library->getAllRoms(searchPaths);
+        auto second = library->getAllRoms(searchPaths);
+        const auto firstCanceled = first.isCanceled();
+        released = true;
+        while (!second.isFinished()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        }
+        // The queued scan is handed out again rather than replaced by a new one.
+        CHECK_FALSE(firstCanceled);
+        CHECK(first.isFinished());
+        CHECK_FALSE(second.isCanceled());
+        REQUIRE(first.resultCount() == 1);
+        REQUIRE(second.resultCount() == 1);
+        CHECK(first.result() == second.result());
+    }
+
+    SECTION("Superseded Request")
+    {
+        auto superseded = library->getAllRoms(searchPaths);
+        auto current = library->getAllRoms({otherLibraryDir.path()});
+        const auto supersededCanceled = superseded.isCanceled();
+        released = true;
+        while (!current.isFinished()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        }
+        CHECK(supersededCanceled);
+        CHECK(superseded.resultCount() == 0);
+        REQUIRE(current.resultCount() == 1);
+        CHECK(current.result().size() == 2);
+    }
+
+    released = true;
+    while (!holdFuture.isFinished()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    }
+}
+
+// Reads only get their own connections when the library is a file, but the library is opened once per process and the
+// other tests open it in memory. This is hidden from the default run and given its own process by CMakeLists.txt.
+TEST_CASE_METHOD(RomLibraryFixture, "Read While Scanning", "[.][file-library]")
+{
+    // The directory must outlive the test because the library stays open until the program exits.
+    static QTemporaryDir dbDir;
+    REQUIRE(dbDir.isValid());
+    const auto dbPath = dbDir.filePath("patchman.db");
+    qputenv("PATCHMAN_DB_PATH", dbPath.toUtf8());
+    auto *library = patchman::RomLibrary::get();
+    // Fails if another test opened the library first.
+    REQUIRE(QFileInfo::exists(dbPath));
+
+    constexpr auto kBatchSize = 200;
+    QTemporaryDir libraryDir;
+    REQUIRE(libraryDir.isValid());
+    const auto copyRoms = [&libraryDir](const QString &batchName)
+    {
+        REQUIRE(QDir(libraryDir.path()).mkdir(batchName));
+        for (int romNum = 0; romNum < kBatchSize; ++romNum) {
+            REQUIRE(QFile::copy(TEST_SOURCES_DIR "/roms/enr_bal_294.bin",
+                                QDir(libraryDir.filePath(batchName)).filePath(QString("%1.bin").arg(romNum))));
+        }
+    };
+    const QStringList searchPaths{libraryDir.path()};
+    copyRoms("first");
+    const auto firstRoms = scan(searchPaths);
+    REQUIRE(firstRoms.size() == kBatchSize);
+    CHECK(QFileInfo::exists(dbPath + "-wal"));
+
+    copyRoms("second");
+    auto scanFuture = library->getAllRoms(searchPaths);
+    auto countsFuture = library->getPatchHashCounts();
+    auto matchesFuture = library->findAddress(1, 0);
+    auto patchTableFuture = library->getPatchTable(firstRoms.first());
+    while (!countsFuture.isFinished() || !matchesFuture.isFinished() || !patchTableFuture.isFinished()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    }
+    // Reads were not queued behind the scan, and see the library as it was before the scan started writing.
+    CHECK_FALSE(scanFuture.isFinished());
+    const auto counts = countsFuture.result();
+    REQUIRE(counts.size() == 1);
+    CHECK(counts.value(firstRoms.first().getPatchHash()) == kBatchSize);
+    CHECK(matchesFuture.result().size() == kBatchSize);
+    auto *expectedRom = patchman::Rom::create(patchman::Rom::Type::ENR);
+    expectedRom->loadFromFile(firstRoms.first().getFilePath());
+    CHECK(patchTableFuture.result() == expectedRom->toPatchTable());
+
+    while (!scanFuture.isFinished()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    }
+    REQUIRE(scanFuture.result().size() == 2 * kBatchSize);
+    countsFuture = library->getPatchHashCounts();
+    while (!countsFuture.isFinished()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    }
+    CHECK(countsFuture.result().value(firstRoms.first().getPatchHash()) == 2 * kBatchSize);
+}
@@ -0,0 +1,80 @@
+/**
+ * @file SimilarityTest.cpp
+ *
+ * @author Dan Keenan
+ * @date 10/18/26
+ * @copyright GNU GPLv3
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <memory>
+#include "patchlib/library/RomSimilarity.h"
+#include "patchlib/Rom.h"
+#include "patchlib/Exceptions.h"
+
+TEST_CASE("ROM Similarity")
+{
+    const std::unique_ptr<patchman::Rom> rom(patchman::Rom::createFromFile(TEST_SOURCES_DIR "/roms/enr_bal_294.bin"));
+    const auto original = rom->toPatchTable();
+    const patchman::PatchTableView originalView(original);
+
+    SECTION("Identical") {
+        const auto copy = rom->toPatchTable();
+        const patchman::PatchTableView copyView(copy);
+        CHECK(patchman::RomSimilarity::countLugEdits(originalView, copyView) == 0);
+        CHECK(patchman::RomSimilarity::similarity(originalView, copyView) == 1.0);
+        CHECK(patchman::RomSimilarity::signature(originalView) == patchman::RomSimilarity::signature(copyView));
+    }
+
+    SECTION("Edited") {
+        auto *rack = rom->getRack(0);
+        rack->setLugAddress(0, rack->getLugAddress(0) + 1);
+        rack->setLugAddress(1, rack->getLugAddress(1) + 1);
+        rom->getRack(1)->setLugAddress(5, 512);
+        const auto edited = rom->toPatchTable();
+        const patchman::PatchTableView editedView(edited);
+        CHECK(patchman::RomSimilarity::countLugEdits(originalView, editedView) == 3);
+        CHECK(patchman::RomSimilarity::countLugEdits(editedView, originalView) == 3);
+        const auto similarity = patchman::RomSimilarity::similarity(originalView, editedView);
+        CHECK(similarity < 1.0);
+        CHECK(similarity > 0.9);
+        CHECK(similarity == patchman::RomSimilarity::similarity(editedView, originalView));
+
+        // A handful of edits out of hundreds of lugs should leave most bands unchanged.
+        const auto originalBands = patchman::RomSimilarity::bandHashes(patchman::RomSimilarity::signature(originalView));
+        const auto editedBands = patchman::RomSimilarity::bandHashes(patchman::RomSimilarity::signature(editedView));
+        REQUIRE(originalBands.size() == patchman::RomSimilarity::kBandCount);
+        REQUIRE(editedBands.size() == patchman::RomSimilarity::kBandCount);
+        unsigned int sharedBands = 0;
+        for (unsigned int band = 0; band < patchman::RomSimilarity::kBandCount; ++band) {
+            if (originalBands.at(band) == editedBands.at(band)) {
+                ++sharedBands;
+            }
+        }
+        CHECK(sharedBands > 0);
+    }
+
+    SECTION("Disjoint") {
+        // Same number of patched racks, but none in common.
+        const std::unique_ptr<patchman::Rom> other(patchman::Rom::fromPatchTable(original));
+        for (unsigned int rackNum = 0; rackNum < 6; ++rackNum) {
+            auto *rack = other->getRack(rackNum);
+            auto *emptyRack = other->getRack(rackNum + 6);
+            REQUIRE(rack->isPatched());
+            REQUIRE_FALSE(emptyRack->isPatched());
+            for (unsigned int lug = 0; lug < rack->getLugCount(); ++lug) {
+                emptyRack->setLugWord(lug, rack->getLugWord(lug));
+                rack->setLugWord(lug, 0);
+            }
+        }
+        const auto disjoint = other->toPatchTable();
+        const patchman::PatchTableView disjointView(disjoint);
+        CHECK(patchman::RomSimilarity::similarity(originalView, disjointView) == 0.0);
+        CHECK(patchman::RomSimilarity::similarity(disjointView, originalView) == 0.0);
+    }
+
+    SECTION("Invalid patch table") {
+        CHECK_THROWS_AS(patchman::PatchTableView(QByteArrayView("\x01\x02\x00\x05", 4)),
+                        patchman::InvalidRomException);
+    }
+}